@@ -1,5 +1,8 @@
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include <papi.h>
@@ -15,6 +18,12 @@
 #include "hashtable/dense_hash_map.h"
 #include "hashtable/sparse_hash_map.h"
 #include "hashtable/unordered_map.h"
+#include "hashtable/open_addressing.h"
+#include "hashtable/btree_map.h"
+#include "hashtable/adaptive_hash_map.h"
+#include "hashtable/pod16.h"
+#include "hashtable/rcu_hash_map.h"
+#include "hashtable/concurrent_read.h"
 #include "hashtable/microbenchmark.h"
 #include "hashtable/wordcount.h"
 
@@ -30,6 +39,8 @@ void usage(char* name) {
          << "-c <double>   cutoff, at which difference ratio to stop printing (deafult: 1.01)" << endl
          << "-m <int>      maximum number of differences to print (default: 25)" << endl
          << "-b <int>      which contender to compare to the others (default: 0)" << endl
+         << "-k <types>    comma-separated key types to benchmark (default: int,uint64,pod16)" << endl
+         << "              results for key types other than int get the type's name appended" << endl
          << endl
          << "Instrumentation options:" << endl
          << "-nt           disable timer instrumentation" << endl
@@ -39,52 +50,63 @@ void usage(char* name) {
     exit(0);
 }
 
-int main(int argc, char** argv) {
-    // Parse command-line arguments
-    common::arg_parser args(argc, argv);
-    if (args.is_set("h") || args.is_set("-help")) usage(argv[0]);
-    const std::string resultfn_prefix = args.get<std::string>("p", "results_hash_"),
-                      serializationfn = args.get<std::string>("o", "data_hash.txt");
-    const int repetitions    = args.get<int>("n", 1),
-              max_results    = args.get<int>("m", 25),
-              base_contender = args.get<int>("b", 0);
-    const double cutoff = args.get<double>("c", 1.01);
-    __attribute__((unused)) // don't warn when compiling malloc target
-    const bool disable_timer      = args.is_set("nt"),
-               disable_papi_cache = args.is_set("npc") || args.is_set("np"),
-               disable_papi_instr = args.is_set("npi") || args.is_set("np"),
-               append_results = args.is_set("a");
-
-    using HashTable = hashtable::hashtable<int, int>;
+struct options {
+    std::string resultfn_prefix, serializationfn;
+    int repetitions, max_results, base_contender;
+    double cutoff;
+    bool disable_timer, disable_papi_cache, disable_papi_instr, append_results;
+};
+
+/// Run all benchmarks on hash tables with keys of type Key. Results for keys
+/// other than int go to files with the key type's name in them.
+template <typename Key>
+void run_benchmarks(const std::string &key_name, const options &opts) {
+    using HashTable = hashtable::hashtable<Key, int>;
     using Configuration = std::pair<size_t, size_t>;
     using Benchmark = common::benchmark<HashTable, Configuration>;
 
+    const bool is_default = std::is_same<Key, int>::value;
+    const std::string resultfn_prefix = opts.resultfn_prefix + (is_default ? "" : key_name + "_");
+    std::string serializationfn = opts.serializationfn;
+    if (!is_default) {
+        const size_t dot = serializationfn.rfind('.');
+        serializationfn.insert(dot == std::string::npos ? serializationfn.size() : dot, "_" + key_name);
+    }
+
+    std::cout << common::term::bold << "Hash tables with " << key_name << " keys"
+              << common::term::reset << std::endl;
+
     // Set up data structure contenders
     common::contender_list<HashTable> contenders;
     // TODO: add your own implemenation here!
+    hashtable::open_addressing<Key, int>::register_contenders(contenders);
+    hashtable::rcu_hash_map<Key, int>::register_contenders(contenders);
+    hashtable::btree_map<Key, int>::register_contenders(contenders);
+    hashtable::adaptive_hash_map<Key, int>::register_contenders(contenders);
 
     // Add wrappers around std::unordered_map and Google's libsparsehash
-    hashtable::unordered_map<int, int>::register_contenders(contenders);
-    hashtable::dense_hash_map<int, int>::register_contenders(contenders);
-    hashtable::sparse_hash_map<int, int>::register_contenders(contenders);
+    hashtable::unordered_map<Key, int>::register_contenders(contenders);
+    hashtable::dense_hash_map<Key, int>::register_contenders(contenders);
+    hashtable::sparse_hash_map<Key, int>::register_contenders(contenders);
 
     // Register Benchmarks
     common::contender_list<Benchmark> benchmarks;
     hashtable::microbenchmark<HashTable>::register_benchmarks(benchmarks);
     hashtable::wordcount<HashTable>::register_benchmarks(benchmarks);
+    hashtable::concurrent_read<HashTable>::register_benchmarks(benchmarks);
 
     // Register instrumentations
     common::contender_list<common::instrumentation> instrumentations;
 #ifndef MALLOC_INSTR
-    if (!disable_timer)
+    if (!opts.disable_timer)
     instrumentations.register_contender("timer", "timer",
         [](){ return new common::timer_instrumentation(); });
 
-    if (!disable_papi_cache)
+    if (!opts.disable_papi_cache)
     instrumentations.register_contender("PAPI cache", "PAPI_cache",
         [](){ return new common::papi_instrumentation_cache(); });
 
-    if (!disable_papi_instr)
+    if (!opts.disable_papi_instr)
     instrumentations.register_contender("PAPI instruction", "PAPI_instr",
         [](){ return new common::papi_instrumentation_instr(); });
 #else
@@ -96,17 +118,42 @@ int main(int argc, char** argv) {
 
     // Run the benchmarks
     common::experiment_runner<HashTable, Configuration> runner(contenders, instrumentations, benchmarks, results);
-    runner.run(repetitions, resultfn_prefix);
+    runner.run(opts.repetitions, resultfn_prefix);
 
     // Evaluate the result
     if (contenders.size() > 1) {
-        common::comparison comparison(results, base_contender);
+        common::comparison comparison(results, opts.base_contender);
         comparison.compare();
-        comparison.print(std::cout, cutoff, max_results);
+        comparison.print(std::cout, opts.cutoff, opts.max_results);
     }
 
     // Serialize results to disk for further evaluation
-    runner.serialize(serializationfn, append_results);
+    runner.serialize(serializationfn, opts.append_results);
 
     runner.shutdown();
 }
+
+int main(int argc, char** argv) {
+    // Parse command-line arguments
+    common::arg_parser args(argc, argv);
+    if (args.is_set("h") || args.is_set("-help")) usage(argv[0]);
+    options opts;
+    opts.resultfn_prefix = args.get<std::string>("p", "results_hash_");
+    opts.serializationfn = args.get<std::string>("o", "data_hash.txt");
+    opts.repetitions    = args.get<int>("n", 1);
+    opts.max_results    = args.get<int>("m", 25);
+    opts.base_contender = args.get<int>("b", 0);
+    opts.cutoff = args.get<double>("c", 1.01);
+    opts.disable_timer      = args.is_set("nt");
+    opts.disable_papi_cache = args.is_set("npc") || args.is_set("np");
+    opts.disable_papi_instr = args.is_set("npi") || args.is_set("np");
+    opts.append_results = args.is_set("a");
+    const std::string key_types = "," + args.get<std::string>("k", "int,uint64,pod16") + ",";
+
+    if (key_types.find(",int,") != std::string::npos)
+        run_benchmarks<int>("int", opts);
+    if (key_types.find(",uint64,") != std::string::npos)
+        run_benchmarks<uint64_t>("uint64", opts);
+    if (key_types.find(",pod16,") != std::string::npos)
+        run_benchmarks<hashtable::pod16>("pod16", opts);
+}
@@ -1,5 +1,8 @@
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 #include <papi.h>
@@ -15,8 +18,35 @@
 #include "pq/priority_queue.h"
 #include "pq/std_pq.h"
 #include "pq/gnu_pq.h"
+#include "pq/dary_heap.h"
+#include "pq/weak_heap.h"
+#include "pq/min_max_heap.h"
+#include "pq/top_k_queue.h"
+#include "pq/loser_tree.h"
+#include "pq/soa_heap.h"
+#include "pq/sequence_heap.h"
+#include "pq/radix_heap.h"
+#include "pq/bucket_queue.h"
+#include "pq/bitset_queue.h"
+#include "pq/pairing_heap.h"
+#include "pq/fibonacci_heap.h"
+#include "pq/binomial_heap.h"
+#include "pq/rank_pairing_heap.h"
+#include "pq/multiqueue.h"
+#include "pq/skiplist_pq.h"
+#include "pq/external_pq.h"
 #include "pq/microbenchmark.h"
 #include "pq/heapsort.h"
+#include "pq/kway_merge.h"
+#include "pq/top_k.h"
+#include "pq/decrease_key.h"
+#include "pq/dijkstra.h"
+#include "pq/pairwise_meld.h"
+#include "pq/concurrent_push_pop.h"
+#include "pq/expensive_compare.h"
+#include "pq/string_key.h"
+#include "pq/record.h"
+#include "pq/record_benchmark.h"
 
 void usage(char* name) {
     using std::cout;
@@ -30,69 +60,175 @@ void usage(char* name) {
          << "-c <double>   cutoff, at which difference ratio to stop printing (deafult: 1.01)" << endl
          << "-m <int>      maximum number of differences to print (default: 25)" << endl
          << "-b <int>      which contender to compare to the others (default: 0)" << endl
+         << "-t <types>    comma-separated element types to benchmark (default: int,uint32)" << endl
+         << "              results for types other than int get the type's name appended" << endl
+         << "              string runs benchmarks with expensive comparisons" << endl
+         << "              pair, record32 and boxed run benchmarks on records of a key and" << endl
+         << "              an 8-byte, 24-byte or 40-byte payload, the last one on the heap" << endl
+         << "-e <int>      memory budget of external-memory queues in MiB (default: 16)" << endl
          << endl
          << "Instrumentation options:" << endl
          << "-nt           disable timer instrumentation" << endl
          << "-np           disable all PAPI instrumentations" << endl
          << "-npc          disable PAPI cache instrumentation" << endl
-         << "-npi          disable PAPI instruction instrumentation" << endl;
+         << "-npi          disable PAPI instruction instrumentation" << endl
+         << "-io           enable I/O volume instrumentation" << endl;
     exit(0);
 }
 
-int main(int argc, char** argv) {
-    // Parse command-line arguments
-    common::arg_parser args(argc, argv);
-    if (args.is_set("h") || args.is_set("-help")) {
-        usage(argv[0]);
-    }
-    const std::string resultfn_prefix = args.get<std::string>("p", "results_pq_"),
-                      serializationfn = args.get<std::string>("o", "data_pq.txt");
-    const int repetitions    = args.get<int>("n", 1),
-              max_results    = args.get<int>("m", 25),
-              base_contender = args.get<int>("b", 0);
-    const double cutoff = args.get<double>("c", 1.01);
-    __attribute__((unused)) // don't warn when compiling malloc target
-    const bool disable_timer      = args.is_set("nt"),
-               disable_papi_cache = args.is_set("npc") || args.is_set("np"),
-               disable_papi_instr = args.is_set("npi") || args.is_set("np"),
-               append_results = args.is_set("a");
-
-    using PQ = pq::priority_queue<int>;
+struct options {
+    std::string resultfn_prefix, serializationfn;
+    int repetitions, max_results, base_contender;
+    size_t external_budget;
+    double cutoff;
+    bool disable_timer, disable_papi_cache, disable_papi_instr, enable_io, append_results;
+};
+
+/// Register the contenders that only support unsigned integer elements
+template <typename T>
+typename std::enable_if<std::is_unsigned<T>::value>::type
+register_unsigned_contenders(common::contender_list<pq::priority_queue<T>> &contenders) {
+    pq::radix_heap<T>::register_contenders(contenders);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_unsigned<T>::value>::type
+register_unsigned_contenders(common::contender_list<pq::priority_queue<T>> &) {}
+
+/// Register the contenders that only support unsigned integers of up to 32 bits
+template <typename T>
+typename std::enable_if<std::is_unsigned<T>::value && sizeof(T) <= 4>::type
+register_uint32_contenders(common::contender_list<pq::priority_queue<T>> &contenders) {
+    pq::bitset_queue<T>::register_contenders(contenders);
+}
+
+template <typename T>
+typename std::enable_if<!(std::is_unsigned<T>::value && sizeof(T) <= 4)>::type
+register_uint32_contenders(common::contender_list<pq::priority_queue<T>> &) {}
+
+/// Register the contenders that only support integer elements
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type
+register_integer_contenders(common::contender_list<pq::priority_queue<T>> &contenders, const options &opts) {
+    pq::loser_tree<T>::register_contenders(contenders);
+    pq::bucket_queue<T>::register_contenders(contenders);
+    pq::multiqueue<T>::register_contenders(contenders);
+    pq::external_pq<T>::register_contenders(contenders, opts.external_budget);
+    register_unsigned_contenders<T>(contenders);
+    register_uint32_contenders<T>(contenders);
+}
+
+template <typename T>
+typename std::enable_if<!std::is_integral<T>::value>::type
+register_integer_contenders(common::contender_list<pq::priority_queue<T>> &, const options &) {}
+
+/// Register the contenders that only support records of a key and a payload
+template <typename T>
+typename std::enable_if<pq::record_traits<T>::is_record>::type
+register_record_contenders(common::contender_list<pq::priority_queue<T>> &contenders) {
+    pq::soa_heap<T>::register_contenders(contenders);
+}
+
+template <typename T>
+typename std::enable_if<!pq::record_traits<T>::is_record>::type
+register_record_contenders(common::contender_list<pq::priority_queue<T>> &) {}
+
+/// Register the benchmarks for integer elements, which generate them from
+/// random numbers
+template <typename PQ, typename Benchmark>
+typename std::enable_if<std::is_integral<typename PQ::value_type>::value>::type
+register_type_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+    pq::microbenchmark<PQ>::register_benchmarks(benchmarks);
+    pq::heapsort<PQ>::register_benchmarks(benchmarks);
+    pq::kway_merge<PQ>::register_benchmarks(benchmarks);
+    pq::top_k<PQ>::register_benchmarks(benchmarks);
+    pq::decrease_key<PQ>::register_benchmarks(benchmarks);
+    pq::dijkstra<PQ>::register_benchmarks(benchmarks);
+    pq::pairwise_meld<PQ>::register_benchmarks(benchmarks);
+    pq::concurrent_push_pop<PQ>::register_benchmarks(benchmarks);
+}
+
+/// Register the benchmarks for string keys, which count comparisons
+template <typename PQ, typename Benchmark>
+typename std::enable_if<std::is_same<typename PQ::value_type, pq::string_key>::value>::type
+register_type_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+    pq::expensive_compare<PQ>::register_benchmarks(benchmarks);
+}
+
+/// Register the benchmarks for records, which move larger elements
+template <typename PQ, typename Benchmark>
+typename std::enable_if<pq::record_traits<typename PQ::value_type>::is_record>::type
+register_type_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+    pq::record_benchmark<PQ>::register_benchmarks(benchmarks);
+}
+
+/// Run all benchmarks on priority queues of elements of type T. Results for
+/// types other than int go to files with the type's name in them.
+template <typename T>
+void run_benchmarks(const std::string &type_name, const options &opts) {
+    using PQ = pq::priority_queue<T>;
     using Configuration = std::pair<size_t, size_t>;
     using Benchmark = common::benchmark<PQ, Configuration>;
 
+    const bool is_default = std::is_same<T, int>::value;
+    const std::string resultfn_prefix = opts.resultfn_prefix + (is_default ? "" : type_name + "_");
+    std::string serializationfn = opts.serializationfn;
+    if (!is_default) {
+        const size_t dot = serializationfn.rfind('.');
+        serializationfn.insert(dot == std::string::npos ? serializationfn.size() : dot, "_" + type_name);
+    }
+
+    std::cout << common::term::bold << "Priority queues of " << type_name << " elements"
+              << common::term::reset << std::endl;
+
     // Set up data structure contenders
     common::contender_list<PQ> contenders;
     // TODO: add your own implementation here!
+    pq::dary_heap<T>::register_contenders(contenders);
+    pq::weak_heap<T>::register_contenders(contenders);
+    pq::min_max_heap<T>::register_contenders(contenders);
+    pq::top_k_queue<T>::register_contenders(contenders);
+    pq::sequence_heap<T>::register_contenders(contenders);
+    pq::pairing_heap<T>::register_contenders(contenders);
+    pq::fibonacci_heap<T>::register_contenders(contenders);
+    pq::binomial_heap<T>::register_contenders(contenders);
+    pq::rank_pairing_heap<T>::register_contenders(contenders);
+    pq::skiplist_pq<T>::register_contenders(contenders);
+    register_integer_contenders<T>(contenders, opts);
+    register_record_contenders<T>(contenders);
 
     // Add std::priority_queue
-    pq::std_pq<int>::register_contenders(contenders);
+    pq::std_pq<T>::register_contenders(contenders);
 
 #if defined(__GNUG__) && !(defined(__APPLE_CC__))
     // These are from GNU libstdc++ policy-based datastructures library
     // Only use if available
-    pq::gnu_pq<int>::register_contenders(contenders);
+    pq::gnu_pq<T>::register_contenders(contenders);
+    pq::gnu_addressable_pq<T>::register_contenders(contenders);
 #endif
 
     // Register Benchmarks
     common::contender_list<Benchmark> benchmarks;
-    pq::microbenchmark<PQ>::register_benchmarks(benchmarks);
-    pq::heapsort<PQ>::register_benchmarks(benchmarks);
+    register_type_benchmarks<PQ>(benchmarks);
 
     // Register instrumentations
     common::contender_list<common::instrumentation> instrumentations;
 #ifndef MALLOC_INSTR
-    if (!disable_timer)
+    if (!opts.disable_timer)
     instrumentations.register_contender("timer", "timer",
         [](){ return new common::timer_instrumentation(); });
 
-    if (!disable_papi_cache)
+    if (!opts.disable_papi_cache)
     instrumentations.register_contender("PAPI cache", "PAPI_cache",
         [](){ return new common::papi_instrumentation_cache(); });
 
-    if (!disable_papi_instr)
+    if (!opts.disable_papi_instr)
     instrumentations.register_contender("PAPI instruction", "PAPI_instr",
         [](){ return new common::papi_instrumentation_instr(); });
+
+    if (opts.enable_io)
+    instrumentations.register_contender("I/O volume", "io",
+        [](){ return new common::io_instrumentation(); });
 #else
     instrumentations.register_contender("memory usage", "memory",
         [](){ return new common::memory_instrumentation(); });
@@ -102,17 +238,50 @@ int main(int argc, char** argv) {
 
     // Run the benchmarks
     common::experiment_runner<PQ, Configuration> runner(contenders, instrumentations, benchmarks, results);
-    runner.run(repetitions, resultfn_prefix);
+    runner.run(opts.repetitions, resultfn_prefix);
 
     // Evaluate the result
     if (contenders.size() > 1) {
-        common::comparison comparison(results, base_contender);
+        common::comparison comparison(results, opts.base_contender);
         comparison.compare();
-        comparison.print(std::cout, cutoff, max_results);
+        comparison.print(std::cout, opts.cutoff, opts.max_results);
     }
 
     // Serialize results to disk for further evaluation
-    runner.serialize(serializationfn, append_results);
+    runner.serialize(serializationfn, opts.append_results);
 
     runner.shutdown();
 }
+
+int main(int argc, char** argv) {
+    // Parse command-line arguments
+    common::arg_parser args(argc, argv);
+    if (args.is_set("h") || args.is_set("-help")) usage(argv[0]);
+    options opts;
+    opts.resultfn_prefix = args.get<std::string>("p", "results_pq_");
+    opts.serializationfn = args.get<std::string>("o", "data_pq.txt");
+    opts.repetitions    = args.get<int>("n", 1);
+    opts.max_results    = args.get<int>("m", 25);
+    opts.base_contender = args.get<int>("b", 0);
+    opts.cutoff = args.get<double>("c", 1.01);
+    opts.disable_timer      = args.is_set("nt");
+    opts.disable_papi_cache = args.is_set("npc") || args.is_set("np");
+    opts.disable_papi_instr = args.is_set("npi") || args.is_set("np");
+    opts.enable_io = args.is_set("io");
+    opts.external_budget = args.get<size_t>("e", 16) << 20;
+    opts.append_results = args.is_set("a");
+    const std::string types = "," + args.get<std::string>("t", "int,uint32") + ",";
+
+    if (types.find(",int,") != std::string::npos)
+        run_benchmarks<int>("int", opts);
+    if (types.find(",uint32,") != std::string::npos)
+        run_benchmarks<uint32_t>("uint32", opts);
+    if (types.find(",string,") != std::string::npos)
+        run_benchmarks<pq::string_key>("string", opts);
+    if (types.find(",pair,") != std::string::npos)
+        run_benchmarks<pq::pair_record>("pair", opts);
+    if (types.find(",record32,") != std::string::npos)
+        run_benchmarks<pq::record32>("record32", opts);
+    if (types.find(",boxed,") != std::string::npos)
+        run_benchmarks<pq::boxed_record>("boxed", opts);
+}
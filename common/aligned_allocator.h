@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+namespace common {
+
+/// Allocator for standard containers that aligns storage to Alignment bytes,
+/// e.g. to cache lines. operator new doesn't honour over-aligned types
+/// before C++17.
+template <typename T, size_t Alignment = 64>
+class aligned_allocator {
+    static_assert(Alignment >= alignof(void*) && (Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two and at least pointer-sized");
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+    aligned_allocator() = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment> &) {}
+
+    T* allocate(const size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, Alignment, n * sizeof(T)) != 0)
+            throw std::bad_alloc();
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T *ptr, size_t) {
+        free(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Alignment> &) const { return true; }
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Alignment> &) const { return false; }
+};
+
+}
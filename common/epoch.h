@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "aligned_allocator.h"
+
+namespace common {
+
+/// Epoch-based memory reclamation. Readers pin the current epoch while they
+/// access shared memory (a load and a store, so they are wait-free), writers
+/// retire memory that they unlinked and free it once every reader that could
+/// still see it has left its critical section.
+class epoch_manager {
+public:
+    static constexpr size_t max_threads = 256;
+
+    /// RAII guard for a reader's critical section, guards may be nested
+    class guard {
+    public:
+        explicit guard(epoch_manager &manager) : manager(manager) {
+            manager.enter();
+        }
+        guard(const guard &other) = delete;
+        guard(guard &&other) = delete;
+        ~guard() { manager.exit(); }
+    private:
+        epoch_manager &manager;
+    };
+
+    epoch_manager() : global_epoch(1), slots(max_threads) {
+        for (auto &s : slots) {
+            s.epoch.store(0, std::memory_order_relaxed);
+        }
+    }
+    epoch_manager(const epoch_manager &other) = delete;
+
+    ~epoch_manager() {
+        // No thread may be inside a critical section any more
+        for (auto &s : slots) {
+            for (auto &r : s.retired) {
+                r.deleter(r.ptr);
+            }
+        }
+    }
+
+    /// Schedule ptr for deletion once no reader can access it any more.
+    /// It must already be unreachable for readers that pin after this call.
+    template <typename T>
+    void retire(T *ptr) {
+        slot &s = slots[thread_index()];
+        // Readers that pin from now on observe a newer epoch than the tag
+        const uint64_t tag = global_epoch.fetch_add(1, std::memory_order_seq_cst);
+        s.retired.push_back(retired_ptr{tag, ptr,
+            [](void *p) { delete static_cast<T*>(p); }});
+    }
+
+    /// Free the calling thread's retired memory that is no longer accessible
+    void reclaim() {
+        slot &s = slots[thread_index()];
+        if (s.retired.empty()) return;
+
+        uint64_t oldest = std::numeric_limits<uint64_t>::max();
+        for (const auto &other : slots) {
+            const uint64_t e = other.epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < oldest) oldest = e;
+        }
+
+        size_t kept = 0;
+        for (auto &r : s.retired) {
+            if (r.epoch < oldest) {
+                r.deleter(r.ptr);
+            } else {
+                s.retired[kept++] = r;
+            }
+        }
+        s.retired.resize(kept);
+    }
+
+    /// Number of retired pointers of the calling thread that were not freed yet
+    size_t pending() {
+        return slots[thread_index()].retired.size();
+    }
+
+    /// A small, dense index of the calling thread, reused after threads exit
+    static size_t thread_index() {
+        struct registration {
+            size_t index;
+            registration() {
+                for (index = 0; index < max_threads; ++index) {
+                    bool expected = false;
+                    if (in_use()[index].compare_exchange_strong(expected, true))
+                        break;
+                }
+                // Checked in release builds too, slots[max_threads] is out of
+                // bounds
+                if (index == max_threads) {
+                    throw std::runtime_error("epoch: more than max_threads threads at once");
+                }
+            }
+            ~registration() { in_use()[index].store(false); }
+        };
+        static thread_local registration reg;
+        return reg.index;
+    }
+
+protected:
+    struct retired_ptr {
+        uint64_t epoch;
+        void *ptr;
+        void (*deleter)(void*);
+    };
+
+    struct alignas(64) slot {
+        // announced epoch, 0 if the thread is not in a critical section
+        std::atomic<uint64_t> epoch;
+        // nesting depth of critical sections, only accessed by the owner
+        size_t depth = 0;
+        // memory retired by the owner, only accessed by the owner
+        std::vector<retired_ptr> retired;
+    };
+
+    static std::atomic<bool>* in_use() {
+        static std::atomic<bool> used[max_threads];
+        return used;
+    }
+
+    void enter() {
+        slot &s = slots[thread_index()];
+        if (s.depth++ == 0) {
+            s.epoch.store(global_epoch.load(std::memory_order_seq_cst),
+                          std::memory_order_seq_cst);
+        }
+    }
+
+    void exit() {
+        slot &s = slots[thread_index()];
+        if (--s.depth == 0) {
+            s.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    std::atomic<uint64_t> global_epoch;
+    // one cache line per thread
+    std::vector<slot, aligned_allocator<slot, 64>> slots;
+};
+
+}
@@ -9,6 +9,7 @@
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 
+#include "io_stats.h"
 #include "timer.h"
 #include "benchmark.h"
 
@@ -329,6 +330,104 @@ private:
     size_t count;
 };
 
+
+class io_result : public benchmark_result {
+    friend class boost::serialization::access;
+    size_t read, written;
+public:
+    io_result() : read(0), written(0) {}
+    io_result(size_t read, size_t written) : read(read), written(written) {}
+    virtual ~io_result() {}
+
+    bool is_same_type(benchmark_result *other) const override {
+        return dynamic_cast<io_result*>(other) != nullptr;
+    }
+
+    std::ostream& print(std::ostream& os) const override {
+        return os
+            << "bytes read: " << read << "B (" << (1.0 * read) / (1<<20) << " MB)"
+            << "; bytes written: " << written << "B (" << (1.0 * written) / (1<<20) << " MB)";
+    }
+    std::ostream& result(std::ostream& os) const override {
+        return os << " ioread=" << read << " iowritten=" << written;
+    }
+
+    void add(const benchmark_result *const other) override {
+        const io_result* o = dynamic_cast<const io_result*>(other);
+        read    += o->read;
+        written += o->written;
+    };
+    void min(const benchmark_result *const other) override {
+        const io_result* o = dynamic_cast<const io_result*>(other);
+        read    = std::min(read,    o->read   );
+        written = std::min(written, o->written);
+    };
+    void max(const benchmark_result *const other) override {
+        const io_result* o = dynamic_cast<const io_result*>(other);
+        read    = std::max(read,    o->read   );
+        written = std::max(written, o->written);
+    };
+    void div(const int divisor) override {
+        read    /= divisor;
+        written /= divisor;
+    };
+
+    std::vector<double> compare_to(const benchmark_result *other) override {
+        const io_result *o = dynamic_cast<const io_result*>(other);
+        auto divide = [](size_t a,size_t b) -> double {
+            if (a == 0 && b == 0) return 1.0;
+            else return (a * 1.0) / b;
+        };
+        return std::vector<double>{
+            divide(read, o->read),
+            divide(written, o->written)
+        };
+    }
+
+    std::ostream& print_component(int component, std::ostream &os) override {
+        switch (component) {
+        case 0: return os <<    "bytes read: " <<    read << "B (" << (1.0 *    read) / (1<<20) << " MB)";
+        case 1: return os << "bytes written: " << written << "B (" << (1.0 * written) / (1<<20) << " MB)";
+        default: assert(false); return os;
+        }
+    }
+
+    template <typename Archive>
+    void serialize(Archive & ar, const unsigned int) {
+        ar & boost::serialization::base_object<benchmark_result>(*this);
+        ar & read & written;
+    }
+};
+
+/// Measures the external memory I/O volume that data structures report to
+/// io_stats
+class io_instrumentation : public instrumentation {
+public:
+    virtual ~io_instrumentation() = default;
+    void setup() {
+        base_read = io_stats::read();
+        base_written = io_stats::written();
+    }
+
+    void finish() {
+        read = io_stats::read() - base_read;
+        written = io_stats::written() - base_written;
+    }
+
+    virtual io_result* result() const {
+        return new io_result(read, written);
+    }
+
+    virtual io_result* new_result(bool set_to_max = false) const {
+        size_t value = set_to_max ? ((size_t)1) << 62 : 0;
+        return new io_result(value, value);
+    }
+
+private:
+    size_t base_read, base_written;
+    size_t read, written;
+};
+
 }
 
 
@@ -342,3 +441,6 @@ BOOST_CLASS_EXPORT_IMPLEMENT(common::papi_result)
 
 BOOST_CLASS_EXPORT_KEY(common::memory_result)
 BOOST_CLASS_EXPORT_IMPLEMENT(common::memory_result)
+
+BOOST_CLASS_EXPORT_KEY(common::io_result)
+BOOST_CLASS_EXPORT_IMPLEMENT(common::io_result)
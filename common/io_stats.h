@@ -0,0 +1,33 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace common {
+
+/// Global counters of the bytes that data structures read from and wrote to
+/// external memory, which io_instrumentation reports
+class io_stats {
+public:
+    static void add_read(const size_t bytes) {
+        counter(0).fetch_add(bytes, std::memory_order_relaxed);
+    }
+    static void add_written(const size_t bytes) {
+        counter(1).fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static size_t read() {
+        return counter(0).load(std::memory_order_relaxed);
+    }
+    static size_t written() {
+        return counter(1).load(std::memory_order_relaxed);
+    }
+
+protected:
+    static std::atomic<size_t>& counter(const int which) {
+        static std::atomic<size_t> counters[2];
+        return counters[which];
+    }
+};
+
+}
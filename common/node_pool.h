@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace common {
+
+/// Object pool for the nodes of pointer-based data structures. Objects are
+/// carved from chunks that double in size up to max_chunk objects, so n
+/// objects take O(log n + n / max_chunk) mallocs instead of n. Destroyed
+/// objects go to a free list and are reused before the chunks grow. Memory is
+/// returned when the pool is destroyed, which does not run the destructors
+/// of objects that are still alive.
+template <typename T, size_t max_chunk = 1 << 16>
+class node_pool {
+    static_assert(max_chunk > 0, "Chunks must hold objects");
+public:
+    node_pool() : free_list(nullptr), used(0), chunk_size(0) {}
+    node_pool(const node_pool&) = delete;
+    node_pool& operator=(const node_pool&) = delete;
+
+    /// Construct an object in the pool
+    template <typename... Args>
+    T* create(Args&&... args) {
+        slot *s = free_list;
+        if (s != nullptr) {
+            free_list = s->next;
+        } else {
+            if (used == chunk_size) grow();
+            s = &chunks.back()[used++];
+        }
+        return new (&s->storage) T(std::forward<Args>(args)...);
+    }
+
+    /// Destroy an object and keep its memory for reuse
+    void destroy(T *object) {
+        object->~T();
+        slot *s = reinterpret_cast<slot*>(object);
+        s->next = free_list;
+        free_list = s;
+    }
+
+    /// Take over the objects and memory of other, which can then be used
+    /// like a new pool. Objects of other must be destroyed through this pool.
+    void absorb(node_pool &other) {
+        if (&other == this || other.chunks.empty()) return;
+        // The unused part of other's last chunk becomes free slots
+        slot *last = other.chunks.back().get();
+        for (size_t i = other.used; i < other.chunk_size; ++i) {
+            last[i].next = other.free_list;
+            other.free_list = &last[i];
+        }
+        if (other.free_list != nullptr) {
+            slot *tail = other.free_list;
+            while (tail->next != nullptr) tail = tail->next;
+            tail->next = free_list;
+            free_list = other.free_list;
+        }
+        // Our last chunk stays the one new objects are taken from
+        chunks.insert(chunks.begin(), std::make_move_iterator(other.chunks.begin()),
+                      std::make_move_iterator(other.chunks.end()));
+        other.chunks.clear();
+        other.free_list = nullptr;
+        other.used = other.chunk_size = 0;
+    }
+
+    /// Release all memory. Objects that are still alive must not be used
+    /// afterwards and are not destroyed.
+    void release() {
+        chunks.clear();
+        free_list = nullptr;
+        used = chunk_size = 0;
+    }
+
+protected:
+    union slot {
+        slot *next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    void grow() {
+        chunk_size = std::min(std::max<size_t>(2 * chunk_size, 64), max_chunk);
+        chunks.emplace_back(new slot[chunk_size]);
+        used = 0;
+    }
+
+    std::vector<std::unique_ptr<slot[]>> chunks;
+    slot *free_list;
+    size_t used;       // objects taken from the last chunk
+    size_t chunk_size; // size of the last chunk
+};
+
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "hashtable.h"
+#include "key_traits.h"
+#include "open_addressing.h"
+
+namespace hashtable {
+
+/// Hash table that changes its representation as it grows. Up to
+/// small_capacity elements are kept unhashed in an array inside the object
+/// and found by a linear scan. The next insert moves them to an
+/// open_addressing table. If shard_threshold is nonzero, a table that grows
+/// beyond it is split into 2^shard_bits independent tables selected by the
+/// hash, so each of them rehashes a fraction of the elements at a time.
+/// Tables never shrink back, except that clear() returns to the small array.
+/// Like open_addressing, empty_key must not be inserted.
+template <typename Key,
+          typename T,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class adaptive_hash_map : public hashtable<Key, T> {
+public:
+    using table = open_addressing<Key, T, Hash, KeyEqual>;
+    static constexpr size_t small_capacity = 16;
+    static constexpr int shard_bits = 4;
+
+    adaptive_hash_map(const size_t shard_threshold = 0, const Key empty_key = Key{})
+        : hashtable<Key, T>(), shard_threshold(shard_threshold), empty_key(empty_key), small_size(0)
+    {
+        if (has_trivial_slots<Key, T>::value) {
+            std::memset(small_keys, 0, sizeof(small_keys));
+        }
+    }
+    adaptive_hash_map(const adaptive_hash_map &other) = delete;
+
+    virtual ~adaptive_hash_map() {
+        clear_small();
+    }
+
+    // Register all contenders in the list
+    static void register_contenders(common::contender_list<hashtable<Key, T>> &list) {
+        using Factory = common::contender_factory<hashtable<Key, T>>;
+        list.register_contender(Factory("adaptive", "adaptive",
+            [](){ return new adaptive_hash_map<Key, T, Hash, KeyEqual>(); }
+        ));
+        list.register_contender(Factory("adaptive, sharded past 2^18", "adaptive-sharded",
+            [](){ return new adaptive_hash_map<Key, T, Hash, KeyEqual>(1<<18); }
+        ));
+    }
+
+    T& operator[](const Key &key) override {
+        return find_or_insert(key);
+    }
+
+    T& operator[](Key &&key) override {
+        return find_or_insert(std::move(key));
+    }
+
+    maybe<T> find(const Key &key) const override {
+        if (tables.empty()) {
+            const size_t i = small_find(key);
+            if (i == small_size) return nothing<T>();
+            return just<T>(small_value(i));
+        }
+        return table_for(key).find(key);
+    }
+
+    size_t erase(const Key &key) override {
+        if (!tables.empty()) {
+            return table_for(key).erase(key);
+        }
+        const size_t i = small_find(key);
+        if (i == small_size) return 0;
+        // Fill the gap with the last element
+        --small_size;
+        if (i != small_size) {
+            small_key(i) = std::move(small_key(small_size));
+            small_value(i) = std::move(small_value(small_size));
+        }
+        small_key(small_size).~Key();
+        small_value(small_size).~T();
+        return 1;
+    }
+
+    size_t size() const override {
+        if (tables.empty()) return small_size;
+        size_t num = 0;
+        for (const auto &t : tables) {
+            num += t->size();
+        }
+        return num;
+    }
+
+    void clear() override {
+        clear_small();
+        tables.clear();
+    }
+
+    void for_each(const std::function<void(const Key&, T&)> &f) override {
+        for (size_t i = 0; i < small_size; ++i) {
+            f(small_key(i), small_value(i));
+        }
+        for (auto &t : tables) {
+            t->for_each(f);
+        }
+    }
+
+    hashtable<Key, T>* create_empty() const override {
+        return new adaptive_hash_map(shard_threshold, empty_key);
+    }
+
+protected:
+    using key_storage = typename std::aligned_storage<sizeof(Key), alignof(Key)>::type;
+    using value_storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    Key& small_key(const size_t i) { return *reinterpret_cast<Key*>(&small_keys[i]); }
+    const Key& small_key(const size_t i) const { return *reinterpret_cast<const Key*>(&small_keys[i]); }
+    T& small_value(const size_t i) { return *reinterpret_cast<T*>(&small_values[i]); }
+    const T& small_value(const size_t i) const { return *reinterpret_cast<const T*>(&small_values[i]); }
+
+    // Position of key in the small array, or small_size if it isn't there
+    size_t small_find(const Key &key) const {
+        return small_find(key, std::integral_constant<bool, has_trivial_slots<Key, T>::value>());
+    }
+
+    size_t small_find(const Key &key, std::false_type) const {
+        for (size_t i = 0; i < small_size; ++i) {
+            if (equal(small_key(i), key)) return i;
+        }
+        return small_size;
+    }
+
+    // Compare all slots without branching so that the compiler can use
+    // vector instructions, then pick the first match, which is the lowest
+    // nonzero byte of a word on little endian machines. Slots past
+    // small_size hold zeroes or stale keys, which can only match after the
+    // live copy.
+    size_t small_find(const Key &key, std::true_type) const {
+        static_assert(small_capacity % sizeof(uint64_t) == 0, "compare whole words");
+        uint8_t match[small_capacity];
+        for (size_t i = 0; i < small_capacity; ++i) {
+            match[i] = equal(small_key(i), key);
+        }
+        for (size_t i = 0; i < small_capacity; i += sizeof(uint64_t)) {
+            uint64_t word;
+            std::memcpy(&word, match + i, sizeof(word));
+            if (word != 0) {
+                return std::min<size_t>(i + __builtin_ctzll(word) / 8, small_size);
+            }
+        }
+        return small_size;
+    }
+
+    void clear_small() {
+        for (size_t i = 0; i < small_size; ++i) {
+            small_key(i).~Key();
+            small_value(i).~T();
+        }
+        small_size = 0;
+    }
+
+    // Shards are picked with a different multiplier than open_addressing
+    // uses for its slots, so that each shard's keys still spread over all
+    // of its slots
+    size_t shard_of(const Key &key) const {
+        return (hasher(key) * 0xC2B2AE3D27D4EB4Full) >> (64 - shard_bits);
+    }
+
+    table& table_for(const Key &key) {
+        return tables.size() == 1 ? *tables[0] : *tables[shard_of(key)];
+    }
+
+    const table& table_for(const Key &key) const {
+        return tables.size() == 1 ? *tables[0] : *tables[shard_of(key)];
+    }
+
+    template <typename K>
+    T& find_or_insert(K &&key) {
+        if (tables.empty()) {
+            const size_t i = small_find(key);
+            if (i < small_size) return small_value(i);
+            if (small_size < small_capacity) {
+                new (&small_keys[small_size]) Key(std::forward<K>(key));
+                new (&small_values[small_size]) T();
+                return small_value(small_size++);
+            }
+            grow_to_table();
+        } else if (tables.size() == 1 && shard_threshold > 0 && tables[0]->size() >= shard_threshold) {
+            grow_to_shards();
+        }
+        return table_for(key)[std::forward<K>(key)];
+    }
+
+    // Move the small array's elements into one table
+    void grow_to_table() {
+        std::unique_ptr<table> t(new table(2 * small_capacity, empty_key));
+        for (size_t i = 0; i < small_size; ++i) {
+            (*t)[std::move(small_key(i))] = std::move(small_value(i));
+        }
+        clear_small();
+        tables.push_back(std::move(t));
+    }
+
+    // Distribute the elements of the single table over the shards
+    void grow_to_shards() {
+        std::unique_ptr<table> old = std::move(tables[0]);
+        tables.clear();
+        const size_t shards = size_t(1) << shard_bits;
+        for (size_t s = 0; s < shards; ++s) {
+            tables.emplace_back(new table(2 * old->size() / shards, empty_key));
+        }
+        old->for_each([this](const Key &key, T &value) {
+            tables[shard_of(key)]->operator[](key) = std::move(value);
+        });
+    }
+
+    Hash hasher;
+    KeyEqual equal;
+    const size_t shard_threshold;
+    const Key empty_key;
+    key_storage small_keys[small_capacity];
+    value_storage small_values[small_capacity];
+    size_t small_size;
+    // empty while elements are in the small array, then one table or
+    // 2^shard_bits shards
+    std::vector<std::unique_ptr<table>> tables;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+constexpr size_t adaptive_hash_map<Key, T, Hash, KeyEqual>::small_capacity;
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+constexpr int adaptive_hash_map<Key, T, Hash, KeyEqual>::shard_bits;
+
+}
@@ -0,0 +1,641 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+#include "../common/aligned_allocator.h"
+#include "../common/contenders.h"
+#include "hashtable.h"
+
+namespace hashtable {
+
+namespace detail {
+
+/// Round the number of keys that fit into a node down to a multiple of four,
+/// the SIMD searches read whole vectors. Nodes hold at least four keys.
+constexpr size_t node_capacity(const size_t fits) {
+    return fits < 4 ? 4 : fits / 4 * 4;
+}
+
+/// Find the position of the first key in the sorted array keys[0..n) that
+/// is not less than key. This generic version uses binary search.
+template <typename Key, typename Compare>
+struct node_search {
+    static size_t lower_bound(const Key *keys, const size_t n, const Key &key, const Compare &comp) {
+        return std::lower_bound(keys, keys + n, key, comp) - keys;
+    }
+};
+
+// The SIMD versions compare a whole vector of keys at once and stop at the
+// first vector that holds a key that isn't less than the search key. Nodes
+// are small enough for this linear scan to beat the mispredicted branches of
+// binary search. They read whole vectors, see node_capacity.
+
+#ifdef __SSE2__
+template <typename Key, bool Signed>
+struct simd_search32 {
+    static size_t lower_bound(const Key *keys, const size_t n, const Key &key, const std::less<Key> &) {
+        // SSE2 only compares signed integers, flip the sign bit of unsigned ones
+        const __m128i flip = _mm_set1_epi32(Signed ? 0 : INT32_MIN);
+        const __m128i needle = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(key)), flip);
+        for (size_t i = 0; i < n; i += 4) {
+            const __m128i block = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+            unsigned less = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, needle)));
+            if (n - i < 4) less &= (1u << (n - i)) - 1;
+            if (less != 0xF) return i + __builtin_ctz(~less);
+        }
+        return n;
+    }
+};
+
+template <> struct node_search<int32_t, std::less<int32_t>> : simd_search32<int32_t, true> {};
+template <> struct node_search<uint32_t, std::less<uint32_t>> : simd_search32<uint32_t, false> {};
+#endif
+
+#ifdef __SSE4_2__
+template <typename Key, bool Signed>
+struct simd_search64 {
+    static size_t lower_bound(const Key *keys, const size_t n, const Key &key, const std::less<Key> &) {
+        const __m128i flip = _mm_set1_epi64x(Signed ? 0 : INT64_MIN);
+        const __m128i needle = _mm_xor_si128(_mm_set1_epi64x(static_cast<int64_t>(key)), flip);
+        for (size_t i = 0; i < n; i += 2) {
+            const __m128i block = _mm_xor_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+            unsigned less = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, block)));
+            if (n - i < 2) less &= 1;
+            if (less != 0x3) return i + __builtin_ctz(~less);
+        }
+        return n;
+    }
+};
+
+template <> struct node_search<int64_t, std::less<int64_t>> : simd_search64<int64_t, true> {};
+template <> struct node_search<uint64_t, std::less<uint64_t>> : simd_search64<uint64_t, false> {};
+#endif
+
+}
+
+/// B+ tree with nodes of NodeLines cache lines. Elements are stored in the
+/// leaves only, which are linked to allow ordered scans with for_range().
+/// Keys and values are kept in separate arrays so that searching a node only
+/// touches keys, integer keys are searched with SIMD instructions if
+/// available. Nodes are split in halves, except for a leaf at the right end
+/// of the tree to which a key is appended, so ascending inserts fill leaves
+/// completely. Nodes that drop below half full borrow from or are merged
+/// with a sibling.
+template <typename Key,
+          typename T,
+          typename Compare = std::less<Key>,
+          size_t NodeLines = 4>
+class btree_map : public hashtable<Key, T> {
+    static constexpr size_t node_bytes = NodeLines * 64;
+public:
+    static constexpr size_t leaf_capacity = detail::node_capacity(
+        (node_bytes - sizeof(void*) - sizeof(size_t)) / (sizeof(Key) + sizeof(T)));
+    static constexpr size_t inner_capacity = detail::node_capacity(
+        (node_bytes - sizeof(void*) - sizeof(size_t)) / (sizeof(Key) + sizeof(void*)));
+
+    btree_map() : hashtable<Key, T>(), height(0), num(0) {
+        head = new_leaf();
+        root = head;
+    }
+    btree_map(const btree_map &other) = delete;
+
+    virtual ~btree_map() {
+        free_subtree(root, height);
+    }
+
+    // Register all contenders in the list
+    static void register_contenders(common::contender_list<hashtable<Key, T>> &list) {
+        using Factory = common::contender_factory<hashtable<Key, T>>;
+        list.register_contender(Factory("B+ tree", "btree",
+            [](){ return new btree_map<Key, T, Compare, NodeLines>(); }
+        ));
+    }
+
+    T& operator[](const Key &key) override {
+        return find_or_insert(key);
+    }
+
+    T& operator[](Key &&key) override {
+        return find_or_insert(std::move(key));
+    }
+
+    maybe<T> find(const Key &key) const override {
+        const leaf *l = find_leaf(key);
+        const size_t pos = search(l->keys, l->count, key);
+        if (pos < l->count && !comp(key, l->keys[pos])) {
+            return just<T>(l->values[pos]);
+        }
+        return nothing<T>();
+    }
+
+    size_t erase(const Key &key) override {
+        path p;
+        leaf *l = descend(key, p);
+        const size_t pos = search(l->keys, l->count, key);
+        if (pos == l->count || comp(key, l->keys[pos])) return 0;
+
+        std::move(l->keys + pos + 1, l->keys + l->count, l->keys + pos);
+        std::move(l->values + pos + 1, l->values + l->count, l->values + pos);
+        --l->count;
+        --num;
+        if (height > 0 && l->count < leaf_capacity / 2) {
+            rebalance(p);
+        }
+        return 1;
+    }
+
+    size_t size() const override { return num; }
+
+    void clear() override {
+        free_subtree(root, height);
+        head = new_leaf();
+        root = head;
+        height = 0;
+        num = 0;
+    }
+
+    void for_each(const std::function<void(const Key&, T&)> &f) override {
+        for (leaf *l = head; l != nullptr; l = l->next) {
+            for (size_t i = 0; i < l->count; ++i) {
+                f(l->keys[i], l->values[i]);
+            }
+        }
+    }
+
+    void for_range(const Key &lo, const Key &hi, const std::function<void(const Key&, T&)> &f) override {
+        leaf *l = find_leaf(lo);
+        for (size_t i = search(l->keys, l->count, lo); l != nullptr; l = l->next, i = 0) {
+            for (; i < l->count; ++i) {
+                if (!comp(l->keys[i], hi)) return;
+                f(l->keys[i], l->values[i]);
+            }
+        }
+    }
+
+    hashtable<Key, T>* create_empty() const override {
+        return new btree_map();
+    }
+
+    /// Both trees are sorted, so their leaf chains are merged in one pass
+    /// into new, full leaves, and the inner levels are built on top of them
+    void merge_from(hashtable<Key, T> &&other, const typename hashtable<Key, T>::combiner &combine) override {
+        auto *o = dynamic_cast<btree_map*>(&other);
+        if (o == nullptr) {
+            // Different type, use the generic implementation
+            hashtable<Key, T>::merge_from(std::move(other), combine);
+            return;
+        }
+        if (o == this) {
+            // Merging a tree into itself leaves it as it is
+            return;
+        }
+        if (num == 0) {
+            // Nothing to combine, steal the other tree
+            std::swap(root, o->root);
+            std::swap(head, o->head);
+            std::swap(height, o->height);
+            std::swap(num, o->num);
+            return;
+        }
+        if (o->num == 0) return;
+
+        std::vector<leaf*> leaves;
+        const size_t merged = merge_leaves(head, o->head, combine, leaves);
+        free_subtree(root, height);
+        o->clear();
+        build(leaves);
+        num = merged;
+    }
+
+protected:
+    struct leaf {
+        Key keys[leaf_capacity];
+        T values[leaf_capacity];
+        leaf *next;
+        size_t count;
+    };
+
+    struct inner {
+        Key keys[inner_capacity];
+        // inner nodes on level 1 point to leaves, all others to inner nodes
+        void *children[inner_capacity + 1];
+        size_t count; // number of keys, there is one more child
+    };
+
+    // The inner nodes on the way from the root to a leaf, nodes[i] is on
+    // level i + 1 and we descended into its child index[i]
+    struct path {
+        inner *nodes[64];
+        size_t index[64];
+    };
+
+    leaf* new_leaf() {
+        leaf *l = new (leaf_allocator.allocate(1)) leaf();
+        l->next = nullptr;
+        l->count = 0;
+        return l;
+    }
+
+    inner* new_inner() {
+        inner *in = new (inner_allocator.allocate(1)) inner();
+        in->count = 0;
+        return in;
+    }
+
+    void delete_leaf(leaf *l) {
+        l->~leaf();
+        leaf_allocator.deallocate(l, 1);
+    }
+
+    void delete_inner(inner *in) {
+        in->~inner();
+        inner_allocator.deallocate(in, 1);
+    }
+
+    // Free a node on the given level and all of its descendants
+    void free_subtree(void *node, const size_t level) {
+        if (level == 0) {
+            delete_leaf(static_cast<leaf*>(node));
+            return;
+        }
+        inner *in = static_cast<inner*>(node);
+        for (size_t i = 0; i <= in->count; ++i) {
+            free_subtree(in->children[i], level - 1);
+        }
+        delete_inner(in);
+    }
+
+    template <size_t N>
+    size_t search(const Key (&keys)[N], const size_t n, const Key &key) const {
+        return detail::node_search<Key, Compare>::lower_bound(keys, n, key, comp);
+    }
+
+    // The child of an inner node whose subtree holds key. keys[i] is the
+    // smallest key in the subtree of children[i + 1].
+    size_t child_index(const inner *in, const Key &key) const {
+        size_t i = search(in->keys, in->count, key);
+        if (i < in->count && !comp(key, in->keys[i])) ++i;
+        return i;
+    }
+
+    const leaf* find_leaf(const Key &key) const {
+        const void *node = root;
+        for (size_t level = height; level > 0; --level) {
+            const inner *in = static_cast<const inner*>(node);
+            node = in->children[child_index(in, key)];
+        }
+        return static_cast<const leaf*>(node);
+    }
+
+    leaf* find_leaf(const Key &key) {
+        return const_cast<leaf*>(static_cast<const btree_map*>(this)->find_leaf(key));
+    }
+
+    // Find the leaf for key and record the path to it
+    leaf* descend(const Key &key, path &p) {
+        assert(height < 64);
+        void *node = root;
+        for (size_t level = height; level > 0; --level) {
+            inner *in = static_cast<inner*>(node);
+            const size_t i = child_index(in, key);
+            p.nodes[level - 1] = in;
+            p.index[level - 1] = i;
+            node = in->children[i];
+        }
+        return static_cast<leaf*>(node);
+    }
+
+    template <typename K>
+    T& find_or_insert(K &&key) {
+        path p;
+        leaf *l = descend(key, p);
+        size_t pos = search(l->keys, l->count, key);
+        if (pos < l->count && !comp(key, l->keys[pos])) {
+            return l->values[pos];
+        }
+
+        leaf *right = nullptr;
+        if (l->count == leaf_capacity) {
+            // Split in halves, or leave the leaf full if we're appending
+            const size_t split = (pos == leaf_capacity && l->next == nullptr)
+                ? leaf_capacity : leaf_capacity / 2;
+            right = new_leaf();
+            std::move(l->keys + split, l->keys + leaf_capacity, right->keys);
+            std::move(l->values + split, l->values + leaf_capacity, right->values);
+            right->count = leaf_capacity - split;
+            l->count = split;
+            right->next = l->next;
+            l->next = right;
+            if (pos > split || split == leaf_capacity) {
+                l = right;
+                pos -= split;
+            }
+        }
+
+        std::move_backward(l->keys + pos, l->keys + l->count, l->keys + l->count + 1);
+        std::move_backward(l->values + pos, l->values + l->count, l->values + l->count + 1);
+        l->keys[pos] = std::forward<K>(key);
+        l->values[pos] = T{};
+        ++l->count;
+        ++num;
+
+        if (right != nullptr) {
+            // Inner nodes don't move leaves' elements, so l->values[pos] stays put
+            insert_separator(p, right->keys[0], right);
+        }
+        return l->values[pos];
+    }
+
+    // Insert separator and the new child to its right after the child we
+    // descended into, splitting full inner nodes on the way up
+    void insert_separator(path &p, Key separator, void *child) {
+        for (size_t level = 0; level < height; ++level) {
+            inner *in = p.nodes[level];
+            const size_t i = p.index[level];
+            if (in->count < inner_capacity) {
+                std::move_backward(in->keys + i, in->keys + in->count, in->keys + in->count + 1);
+                std::copy_backward(in->children + i + 1, in->children + in->count + 1,
+                                   in->children + in->count + 2);
+                in->keys[i] = std::move(separator);
+                in->children[i + 1] = child;
+                ++in->count;
+                return;
+            }
+
+            // Lay out all keys and children in order, then distribute them.
+            // The middle key moves up to the parent.
+            Key keys[inner_capacity + 1];
+            void *children[inner_capacity + 2];
+            std::move(in->keys, in->keys + i, keys);
+            keys[i] = std::move(separator);
+            std::move(in->keys + i, in->keys + inner_capacity, keys + i + 1);
+            std::copy(in->children, in->children + i + 1, children);
+            children[i + 1] = child;
+            std::copy(in->children + i + 1, in->children + inner_capacity + 1, children + i + 2);
+
+            const size_t mid = (inner_capacity + 1) / 2;
+            inner *right = new_inner();
+            std::move(keys, keys + mid, in->keys);
+            std::copy(children, children + mid + 1, in->children);
+            in->count = mid;
+            std::move(keys + mid + 1, keys + inner_capacity + 1, right->keys);
+            std::copy(children + mid + 1, children + inner_capacity + 2, right->children);
+            right->count = inner_capacity - mid;
+
+            separator = std::move(keys[mid]);
+            child = right;
+        }
+
+        // The root was split, grow the tree
+        inner *r = new_inner();
+        r->keys[0] = std::move(separator);
+        r->children[0] = root;
+        r->children[1] = child;
+        r->count = 1;
+        root = r;
+        ++height;
+    }
+
+    // Remove key i and child i + 1 from an inner node
+    static void remove_from_inner(inner *in, const size_t i) {
+        std::move(in->keys + i + 1, in->keys + in->count, in->keys + i);
+        std::copy(in->children + i + 2, in->children + in->count + 1, in->children + i + 1);
+        --in->count;
+    }
+
+    // The leaf at the end of path p has fallen below half full, borrow from
+    // or merge with a sibling and fix up the ancestors
+    void rebalance(path &p) {
+        {
+            inner *parent = p.nodes[0];
+            // s is the separator between the siblings left and right
+            const size_t s = p.index[0] > 0 ? p.index[0] - 1 : 0;
+            leaf *left = static_cast<leaf*>(parent->children[s]);
+            leaf *right = static_cast<leaf*>(parent->children[s + 1]);
+            const size_t total = left->count + right->count;
+            if (total <= leaf_capacity) {
+                std::move(right->keys, right->keys + right->count, left->keys + left->count);
+                std::move(right->values, right->values + right->count, left->values + left->count);
+                left->count = total;
+                left->next = right->next;
+                delete_leaf(right);
+                remove_from_inner(parent, s);
+            } else {
+                // Distribute evenly
+                const size_t target = total / 2;
+                if (left->count > target) {
+                    const size_t k = left->count - target;
+                    std::move_backward(right->keys, right->keys + right->count, right->keys + right->count + k);
+                    std::move_backward(right->values, right->values + right->count, right->values + right->count + k);
+                    std::move(left->keys + target, left->keys + left->count, right->keys);
+                    std::move(left->values + target, left->values + left->count, right->values);
+                } else {
+                    const size_t k = target - left->count;
+                    std::move(right->keys, right->keys + k, left->keys + left->count);
+                    std::move(right->values, right->values + k, left->values + left->count);
+                    std::move(right->keys + k, right->keys + right->count, right->keys);
+                    std::move(right->values + k, right->values + right->count, right->values);
+                }
+                left->count = target;
+                right->count = total - target;
+                parent->keys[s] = right->keys[0];
+                return;
+            }
+        }
+
+        // A leaf was merged away, fix inner nodes that became too small
+        for (size_t level = 0; level + 1 < height; ++level) {
+            inner *node = p.nodes[level];
+            if (node->count >= inner_capacity / 2) return;
+
+            inner *parent = p.nodes[level + 1];
+            const size_t s = p.index[level + 1] > 0 ? p.index[level + 1] - 1 : 0;
+            inner *left = static_cast<inner*>(parent->children[s]);
+            inner *right = static_cast<inner*>(parent->children[s + 1]);
+            if (left->count + right->count + 1 <= inner_capacity) {
+                // Merge, the separator moves down between the two
+                left->keys[left->count] = std::move(parent->keys[s]);
+                std::move(right->keys, right->keys + right->count, left->keys + left->count + 1);
+                std::copy(right->children, right->children + right->count + 1,
+                          left->children + left->count + 1);
+                left->count += right->count + 1;
+                delete_inner(right);
+                remove_from_inner(parent, s);
+            } else if (node == left) {
+                // Rotate one child from right to left through the parent
+                left->keys[left->count] = std::move(parent->keys[s]);
+                left->children[left->count + 1] = right->children[0];
+                ++left->count;
+                parent->keys[s] = std::move(right->keys[0]);
+                remove_front(right);
+                return;
+            } else {
+                // Rotate one child from left to right through the parent
+                std::move_backward(right->keys, right->keys + right->count, right->keys + right->count + 1);
+                std::copy_backward(right->children, right->children + right->count + 1,
+                                   right->children + right->count + 2);
+                right->keys[0] = std::move(parent->keys[s]);
+                right->children[0] = left->children[left->count];
+                ++right->count;
+                parent->keys[s] = std::move(left->keys[left->count - 1]);
+                --left->count;
+                return;
+            }
+        }
+
+        // Shrink the tree if the root has only one child left
+        inner *r = static_cast<inner*>(root);
+        if (r->count == 0) {
+            root = r->children[0];
+            delete_inner(r);
+            --height;
+        }
+    }
+
+    // Position in a leaf chain, skipping empty leaves
+    struct cursor {
+        leaf *l;
+        size_t i;
+
+        explicit cursor(leaf *first) : l(first), i(0) { skip_empty(); }
+        bool done() const { return l == nullptr; }
+        Key& key() const { return l->keys[i]; }
+        T& value() const { return l->values[i]; }
+        void advance() {
+            if (++i == l->count) {
+                l = l->next;
+                i = 0;
+                skip_empty();
+            }
+        }
+        void skip_empty() {
+            while (l != nullptr && l->count == 0) l = l->next;
+        }
+    };
+
+    // Merge the elements of two leaf chains into new, linked leaves in key
+    // order, combining the values of keys in both. The leaves are full,
+    // except that the last two share their elements evenly if the last one
+    // would be less than half full. Returns the number of elements.
+    size_t merge_leaves(leaf *ours, leaf *theirs, const typename hashtable<Key, T>::combiner &combine,
+                        std::vector<leaf*> &leaves) {
+        leaves.push_back(new_leaf());
+        size_t merged = 0;
+        auto append = [this, &leaves, &merged](const cursor &from) {
+            leaf *out = leaves.back();
+            if (out->count == leaf_capacity) {
+                out->next = new_leaf();
+                out = out->next;
+                leaves.push_back(out);
+            }
+            out->keys[out->count] = std::move(from.key());
+            out->values[out->count] = std::move(from.value());
+            ++out->count;
+            ++merged;
+        };
+        cursor a(ours), b(theirs);
+        while (!a.done() && !b.done()) {
+            if (comp(a.key(), b.key())) {
+                append(a);
+                a.advance();
+            } else if (comp(b.key(), a.key())) {
+                append(b);
+                b.advance();
+            } else {
+                combine(a.value(), std::move(b.value()));
+                append(a);
+                a.advance();
+                b.advance();
+            }
+        }
+        for (; !a.done(); a.advance()) append(a);
+        for (; !b.done(); b.advance()) append(b);
+
+        if (leaves.size() > 1 && leaves.back()->count < leaf_capacity / 2) {
+            leaf *left = leaves[leaves.size() - 2], *right = leaves.back();
+            const size_t k = (left->count - right->count) / 2;
+            std::move_backward(right->keys, right->keys + right->count, right->keys + right->count + k);
+            std::move_backward(right->values, right->values + right->count, right->values + right->count + k);
+            std::move(left->keys + left->count - k, left->keys + left->count, right->keys);
+            std::move(left->values + left->count - k, left->values + left->count, right->values);
+            left->count -= k;
+            right->count += k;
+        }
+        return merged;
+    }
+
+    // Replace the tree by one with the given linked leaves. Every level is
+    // split into as few inner nodes as possible, with the children
+    // distributed evenly, so all nodes but the root are at least half full.
+    void build(const std::vector<leaf*> &leaves) {
+        std::vector<void*> nodes(leaves.begin(), leaves.end());
+        // The smallest key in the subtree of every node
+        std::vector<Key> mins;
+        mins.reserve(leaves.size());
+        for (const leaf *l : leaves) mins.push_back(l->keys[0]);
+
+        head = leaves.front();
+        height = 0;
+        while (nodes.size() > 1) {
+            const size_t groups = (nodes.size() + inner_capacity) / (inner_capacity + 1);
+            std::vector<void*> parents;
+            std::vector<Key> parent_mins;
+            parents.reserve(groups);
+            parent_mins.reserve(groups);
+            for (size_t g = 0, begin = 0; g < groups; ++g) {
+                const size_t end = nodes.size() * (g + 1) / groups;
+                inner *in = new_inner();
+                in->children[0] = nodes[begin];
+                for (size_t c = begin + 1; c < end; ++c) {
+                    in->keys[c - begin - 1] = std::move(mins[c]);
+                    in->children[c - begin] = nodes[c];
+                }
+                in->count = end - begin - 1;
+                parents.push_back(in);
+                parent_mins.push_back(std::move(mins[begin]));
+                begin = end;
+            }
+            nodes.swap(parents);
+            mins.swap(parent_mins);
+            ++height;
+        }
+        root = nodes.front();
+    }
+
+    // Remove key 0 and child 0 from an inner node
+    static void remove_front(inner *in) {
+        std::move(in->keys + 1, in->keys + in->count, in->keys);
+        std::copy(in->children + 1, in->children + in->count + 1, in->children);
+        --in->count;
+    }
+
+    Compare comp;
+    common::aligned_allocator<leaf> leaf_allocator;
+    common::aligned_allocator<inner> inner_allocator;
+    void *root;
+    leaf *head; // leftmost leaf, where for_each starts
+    size_t height; // number of inner levels above the leaves
+    size_t num;
+};
+
+template <typename Key, typename T, typename Compare, size_t NodeLines>
+constexpr size_t btree_map<Key, T, Compare, NodeLines>::leaf_capacity;
+template <typename Key, typename T, typename Compare, size_t NodeLines>
+constexpr size_t btree_map<Key, T, Compare, NodeLines>::inner_capacity;
+
+}
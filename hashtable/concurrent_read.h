@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+#include "microbenchmark.h"
+
+namespace hashtable {
+
+template <typename HashTable>
+class concurrent_read {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<HashTable, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using Key = typename HashTable::key_type;
+    using T = typename HashTable::mapped_type;
+
+    // Every reader reports its progress in steps of this many finds
+    static constexpr size_t progress_step = 1024;
+    // The writer performs one update per this many finds
+    static constexpr size_t reads_per_write = 1000;
+
+    /// Run readers that find random existing keys of a table filled with
+    /// keys 1..size, while the calling thread modifies the table at a rate
+    /// of one insert or erase per reads_per_write finds. The total number of
+    /// finds is independent of the number of readers, so the running time is
+    /// inversely proportional to the read throughput. Tables that do not
+    /// support concurrent finds are protected by a readers-writer lock.
+    static void run(HashTable &map, const size_t size, const size_t seed, const size_t num_readers) {
+        const size_t total_reads = 16 * size;
+        const size_t reads_per_reader = total_reads / num_readers;
+        const bool locked = !map.concurrent_find();
+
+        std::shared_timed_mutex mutex;
+        std::atomic<size_t> progress{0}, finished{0}, found{0};
+
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < num_readers; ++r) {
+            readers.emplace_back([&, r]() {
+                // xorshift, cheap compared to a find
+                uint64_t state = seed + 0x9E3779B97F4A7C15ull * (r + 1);
+                size_t hits = 0;
+                for (size_t i = 1; i <= reads_per_reader; ++i) {
+                    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                    const Key key = static_cast<Key>(1 + state % size);
+                    if (locked) {
+                        std::shared_lock<std::shared_timed_mutex> lock(mutex);
+                        hits += map.find(key).valid;
+                    } else {
+                        hits += map.find(key).valid;
+                    }
+                    if (i % progress_step == 0) {
+                        progress.fetch_add(progress_step, std::memory_order_relaxed);
+                    }
+                }
+                found.fetch_add(hits, std::memory_order_relaxed);
+                finished.fetch_add(1, std::memory_order_release);
+            });
+        }
+
+        // Single writer: insert fresh keys and erase them again some time
+        // later, so the table's size stays around size + window
+        const size_t window = std::max<size_t>(size / 16, 1);
+        size_t writes = 0;
+        while (finished.load(std::memory_order_acquire) < num_readers) {
+            const size_t target = progress.load(std::memory_order_relaxed) / reads_per_write;
+            if (writes >= target) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (locked) {
+                std::unique_lock<std::shared_timed_mutex> lock(mutex);
+                write(map, size, writes, window);
+            } else {
+                write(map, size, writes, window);
+            }
+            ++writes;
+        }
+
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        // Every reader only looks up keys that are never erased
+        assert(found.load() == num_readers * reads_per_reader);
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<16, 0xDECAF),
+            std::make_pair(1<<20, 0xC0FFEE),
+        };
+
+        // Scale the number of readers from 1 to the number of cores
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<size_t> reader_counts;
+        for (size_t readers = 1; readers < cores; readers *= 2) {
+            reader_counts.push_back(readers);
+        }
+        reader_counts.push_back(cores);
+
+        for (size_t readers : reader_counts) {
+            common::register_benchmark(
+                "concurrent find, " + std::to_string(readers) + " readers + 1 writer",
+                "concurrent-find-" + std::to_string(readers),
+                microbenchmark<HashTable>::fill_map_random,
+                [readers](HashTable &map, Configuration config, void*) {
+                    concurrent_read::run(map, config.first, config.second, readers);
+                }, configs, benchmarks);
+        }
+    }
+
+protected:
+    // alternately insert a fresh key and erase the one inserted window writes ago
+    static void write(HashTable &map, const size_t size, const size_t writes, const size_t window) {
+        const size_t key = size + 1 + writes / 2;
+        if (writes % 2 == 0) {
+            map[static_cast<Key>(key)] = static_cast<T>(writes);
+        } else if (writes / 2 >= window) {
+            map.erase(static_cast<Key>(key - window));
+        }
+    }
+};
+
+}
@@ -16,7 +16,8 @@ template <typename Key,
           typename Alloc = google::libc_allocator_with_realloc<std::pair<const Key, T>>>
 class dense_hash_map : public hashtable<Key, T> {
 public:
-    dense_hash_map(const size_t bucket_count = 0, const Key empty_key = Key{}, const Key deleted_key = Key{-1}) : hashtable<Key, T>(), map(bucket_count) {
+    dense_hash_map(const size_t bucket_count = 0, const Key empty_key = Key{}, const Key deleted_key = static_cast<Key>(-1))
+        : hashtable<Key, T>(), map(bucket_count), empty_key(empty_key), deleted_key(deleted_key) {
         map.set_empty_key(empty_key);
         if (deleted_key != empty_key) {
             map.set_deleted_key(deleted_key);
@@ -61,8 +62,29 @@ public:
 
     void clear() override { map.clear(); }
 
+    void for_each(const std::function<void(const Key&, T&)> &f) override {
+        for (auto &entry : map) {
+            f(entry.first, entry.second);
+        }
+    }
+
+    hashtable<Key, T>* create_empty() const override {
+        return new dense_hash_map(0, empty_key, deleted_key);
+    }
+
+    void merge_from(hashtable<Key, T> &&other, const typename hashtable<Key, T>::combiner &combine) override {
+        auto *o = dynamic_cast<dense_hash_map*>(&other);
+        if (o == nullptr) {
+            // Different type, use the generic implementation
+            hashtable<Key, T>::merge_from(std::move(other), combine);
+            return;
+        }
+        merge_maps(map, o->map, combine, [this](const size_t n) { map.resize(n); });
+    }
+
 protected:
     google::dense_hash_map<Key, T, HashFcn, EqualKey, Alloc> map;
+    const Key empty_key, deleted_key;
 };
 
 }
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <utility>
+
 #include "../common/maybe.h"
 
 using namespace common::monad;
@@ -13,6 +17,9 @@ public:
     using key_type = Key;
     using mapped_type = T;
 
+    /// Combines an incoming value into the value already stored for the same key
+    using combiner = std::function<void(T&, T&&)>;
+
     // You also need to provide the following:
     // static void register_contenders(common::contender_list<hashtable<Key, T>> &list)
 
@@ -35,7 +42,73 @@ public:
     /// Clear the hash table
     virtual void clear() = 0;
 
+    /// Call f on every (key, value) pair, in unspecified order
+    virtual void for_each(const std::function<void(const Key&, T&)> &f) = 0;
+
+    /// Call f on every (key, value) pair with lo <= key < hi. Ordered tables
+    /// visit the keys in ascending order and should override this, the generic
+    /// version filters a full for_each() and visits them in unspecified order.
+    virtual void for_range(const Key &lo, const Key &hi, const std::function<void(const Key&, T&)> &f) {
+        for_each([&lo, &hi, &f](const Key &key, T &value) {
+            if (!(key < lo) && key < hi) f(key, value);
+        });
+    }
+
+    /// Whether find() may be called from many threads while one thread
+    /// modifies the table. Benchmarks guard other tables with a lock.
+    virtual bool concurrent_find() const { return false; }
+
+    /// Create a new, empty hash table of the same type
+    virtual hashtable* create_empty() const = 0;
+
+    /// Move all elements of other into this table, leaving other empty.
+    /// For keys contained in both tables, combine(ours, theirs) is called.
+    /// This generic version re-inserts one element at a time, implementations
+    /// should override it to steal or batch-insert storage of their own type.
+    virtual void merge_from(hashtable &&other, const combiner &combine) {
+        if (&other == this) return;
+        other.for_each([this, &combine](const Key &key, T &value) {
+            const size_t old_size = size();
+            T &slot = (*this)[key];
+            if (size() > old_size) {
+                slot = std::move(value);
+            } else {
+                combine(slot, std::move(value));
+            }
+        });
+        other.clear();
+    }
+
     /// Virtual destructor to allow destruction through derived pointer
     virtual ~hashtable() {}
 };
+
+/// merge_from for tables that wrap a library map with the interface of
+/// std::unordered_map: steal the other map's storage if ours is empty,
+/// otherwise grow ours once with reserve(n) and upsert every element with a
+/// single lookup. theirs is left empty.
+template <typename Map, typename T, typename Reserve>
+void merge_maps(Map &ours, Map &theirs, const std::function<void(T&, T&&)> &combine, Reserve &&reserve) {
+    if (&ours == &theirs) {
+        // Merging a table into itself leaves it as it is, clearing theirs
+        // would lose everything
+        return;
+    }
+    if (ours.empty()) {
+        // Nothing to combine, steal the other table's storage
+        ours.swap(theirs);
+        return;
+    }
+    reserve(ours.size() + theirs.size());
+    for (auto &entry : theirs) {
+        const size_t old_size = ours.size();
+        T &slot = ours[entry.first];
+        if (ours.size() > old_size) {
+            slot = std::move(entry.second);
+        } else {
+            combine(slot, std::move(entry.second));
+        }
+    }
+    theirs.clear();
+}
 }
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace hashtable {
+
+/// Whether two keys are equal if and only if their object representations are
+/// equal. This holds for integers, enums and pointers, specialize it for your
+/// own key types without padding.
+template <typename Key>
+struct is_bitwise_comparable : std::integral_constant<bool,
+    std::is_integral<Key>::value || std::is_enum<Key>::value || std::is_pointer<Key>::value> {};
+
+/// Whether slots holding Key and T can be relocated with memcpy, need no
+/// destruction, and can mark empty slots with a sentinel key
+template <typename Key, typename T>
+struct has_trivial_slots : std::integral_constant<bool,
+    std::is_trivially_copyable<Key>::value &&
+    std::is_trivially_copyable<T>::value &&
+    is_bitwise_comparable<Key>::value> {};
+
+/// Compare the object representations of two keys without branching
+template <typename Key>
+inline bool bitwise_equal(const Key &a, const Key &b) {
+    static_assert(is_bitwise_comparable<Key>::value, "Key isn't bitwise comparable");
+    if (sizeof(Key) % sizeof(uint64_t) != 0) {
+        return std::memcmp(&a, &b, sizeof(Key)) == 0;
+    }
+    // xor all words and check the result once
+    uint64_t diff = 0;
+    for (size_t i = 0; i < sizeof(Key); i += sizeof(uint64_t)) {
+        uint64_t x, y;
+        std::memcpy(&x, reinterpret_cast<const char*>(&a) + i, sizeof(uint64_t));
+        std::memcpy(&y, reinterpret_cast<const char*>(&b) + i, sizeof(uint64_t));
+        diff |= x ^ y;
+    }
+    return diff == 0;
+}
+
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <random>
 #include <type_traits>
 #include <utility>
 
@@ -15,9 +18,19 @@ public:
     using Configuration = std::pair<size_t, size_t>;
     using Benchmark = common::benchmark<HashTable, Configuration>;
     using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using Key = typename HashTable::key_type;
     using T = typename HashTable::mapped_type;
     common::contender_list<Benchmark> benchmarks;
 
+    /// Small tables repeat a benchmark's work in rounds, so that every
+    /// configuration performs at least this many operations and takes long
+    /// enough to be measured
+    static constexpr size_t min_operations = 1<<16;
+
+    static size_t rounds(const Configuration &config) {
+        return std::max<size_t>(min_operations / config.first, 1);
+    }
+
     template <int factor=1>
     static void* fill_data_random(HashTable&, Configuration config, void*) {
         return common::util::fill_data_random<T>(
@@ -46,13 +59,20 @@ public:
     static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
         auto fill = [](HashTable &map, Configuration config, void* ptr) {
             T* data = static_cast<T*>(ptr);
-            for (size_t i = 0; i < config.first; ++i) {
-                map[i+1] = data[i];
+            for (size_t round = 0; round < rounds(config); ++round) {
+                if (round > 0) map.clear();
+                for (size_t i = 0; i < config.first; ++i) {
+                    map[i+1] = data[i];
+                }
             }
             return nullptr;
         };
 
         const std::vector<Configuration> configs{
+            std::make_pair(1<<4, 0x5EED),
+            std::make_pair(1<<6, 0xD1CE),
+            std::make_pair(1<<8, 0xCAFE),
+            std::make_pair(1<<10, 0xFACADE),
             std::make_pair(1<<16, 0xDECAF),
             std::make_pair(1<<18, 0xBEEF),
             std::make_pair(1<<20, 0xC0FFEE),
@@ -70,11 +90,14 @@ public:
             [](HashTable &map, Configuration config, void* ptr) {
                 T* data = static_cast<T*>(ptr);
                 size_t num = config.first;
-                for (size_t i = 0; i < num; ++i) {
-                    map[i+1] = data[i];
-                }
-                for (size_t i = 1; i <= num; ++i) {
-                    map.find(i);
+                for (size_t round = 0; round < rounds(config); ++round) {
+                    if (round > 0) map.clear();
+                    for (size_t i = 0; i < num; ++i) {
+                        map[i+1] = data[i];
+                    }
+                    for (size_t i = 1; i <= num; ++i) {
+                        map.find(i);
+                    }
                 }
             }, microbenchmark::delete_data, configs, benchmarks);
 
@@ -83,31 +106,38 @@ public:
             [](HashTable &map, Configuration &config, void* ptr) {
                 T* data = static_cast<T*>(ptr);
                 size_t num = config.first;
-                for (size_t i = 0; i < num; ++i) {
-                    map[i+1] = data[i];
-                    map.erase(i+1);
-                    map[i+1] = data[num + i];
-                }
-                for (size_t i = 0; i < num; ++i) {
-                    map.erase(i+1);
-                    map[i+1] = data[2*num + i];
-                    map.erase(i+1);
+                // every round leaves the table empty
+                for (size_t round = 0; round < rounds(config); ++round) {
+                    for (size_t i = 0; i < num; ++i) {
+                        map[i+1] = data[i];
+                        map.erase(i+1);
+                        map[i+1] = data[num + i];
+                    }
+                    for (size_t i = 0; i < num; ++i) {
+                        map.erase(i+1);
+                        map[i+1] = data[2*num + i];
+                        map.erase(i+1);
+                    }
                 }
             }, microbenchmark::delete_data, configs, benchmarks);
 
         // access entries that were previously inserted
         common::register_benchmark("access", "access", microbenchmark::fill_map_random,
             [](HashTable &map, Configuration config, void*) {
-                for (size_t i = 1; i <= config.first; ++i) {
-                    (void)map[i];
+                for (size_t round = 0; round < rounds(config); ++round) {
+                    for (size_t i = 1; i <= config.first; ++i) {
+                        (void)map[i];
+                    }
                 }
             }, configs, benchmarks);
 
         // find entries that were previously inserted
         common::register_benchmark("find", "find", microbenchmark::fill_map_random,
             [](HashTable &map, Configuration config, void*) {
-                for (size_t i = 1; i <= config.first; ++i) {
-                    (void)map.find(i);
+                for (size_t round = 0; round < rounds(config); ++round) {
+                    for (size_t i = 1; i <= config.first; ++i) {
+                        (void)map.find(i);
+                    }
                 }
             }, configs, benchmarks);
 
@@ -115,10 +145,29 @@ public:
         common::register_benchmark("find random", "find-random", microbenchmark::fill_both_random<1>,
             [](HashTable &map, Configuration config, void* ptr) {
                 T* data = static_cast<T*>(ptr);
-                for (size_t i = 0; i < config.first; ++i) {
-                    (void)map.find(data[i]+1);
+                for (size_t round = 0; round < rounds(config); ++round) {
+                    for (size_t i = 0; i < config.first; ++i) {
+                        (void)map.find(data[i]+1);
+                    }
                 }
             }, microbenchmark::delete_data, configs, benchmarks);
+
+        // visit all keys in ranges of 1/64th of the key space, starting at
+        // random positions. Unordered tables have to visit all keys per range.
+        common::register_benchmark("range scan", "range-scan", microbenchmark::fill_map_random,
+            [](HashTable &map, Configuration config, void*) {
+                const size_t width = std::max<size_t>(config.first / 64, 1);
+                std::mt19937 gen{config.second};
+                size_t visited = 0;
+                for (size_t i = 0; i < 64 * rounds(config); ++i) {
+                    const size_t lo = 1 + gen() % config.first;
+                    map.for_range(lo, lo + width, [&visited](const Key &, T &) {
+                        ++visited;
+                    });
+                }
+                assert(visited > 0);
+                (void)visited;
+            }, configs, benchmarks);
     }
 };
 }
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../common/contenders.h"
+#include "hashtable.h"
+#include "key_traits.h"
+
+namespace hashtable {
+
+namespace detail {
+
+/// Slots of an open addressing table. This generic version keeps elements
+/// in raw memory plus one flag per slot that marks it as occupied, and moves
+/// and destroys elements one at a time.
+template <typename Key, typename T, typename KeyEqual, bool Trivial>
+class slot_array {
+public:
+    using value_type = std::pair<Key, T>;
+
+    explicit slot_array(const Key &) : slots(nullptr), used(nullptr), cap(0) {}
+    slot_array(const slot_array &other) = delete;
+    ~slot_array() { release(); }
+
+    void init(const size_t capacity) {
+        assert(slots == nullptr);
+        slots = allocator.allocate(capacity);
+        used = new bool[capacity]();
+        cap = capacity;
+    }
+
+    /// Destroy all elements and free the memory
+    void release() {
+        if (slots == nullptr) return;
+        clear();
+        allocator.deallocate(slots, cap);
+        delete[] used;
+        slots = nullptr;
+        used = nullptr;
+        cap = 0;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < cap; ++i) {
+            if (used[i]) erase(i);
+        }
+    }
+
+    bool empty(const size_t i) const { return !used[i]; }
+    bool is_empty_key(const Key &) const { return false; }
+    bool holds(const size_t i, const Key &key) const {
+        return used[i] && equal(slots[i].first, key);
+    }
+
+    const Key& key(const size_t i) const { return slots[i].first; }
+    T& value(const size_t i) { return slots[i].second; }
+    const T& value(const size_t i) const { return slots[i].second; }
+
+    template <typename K>
+    void emplace(const size_t i, K &&key) {
+        assert(!used[i]);
+        new (&slots[i]) value_type(std::forward<K>(key), T{});
+        used[i] = true;
+    }
+
+    void erase(const size_t i) {
+        assert(used[i]);
+        slots[i].~value_type();
+        used[i] = false;
+    }
+
+    /// Move the element in slot i of other into empty slot j, slot i of other
+    /// becomes empty
+    void relocate(slot_array &other, const size_t i, const size_t j) {
+        new (&slots[j]) value_type(std::move(other.slots[i]));
+        used[j] = true;
+        other.erase(i);
+    }
+
+    /// Move the element in slot i into empty slot j, slot i becomes empty
+    void shift(const size_t i, const size_t j) {
+        relocate(*this, i, j);
+    }
+
+    void swap(slot_array &other) {
+        std::swap(slots, other.slots);
+        std::swap(used, other.used);
+        std::swap(cap, other.cap);
+    }
+
+protected:
+    std::allocator<value_type> allocator;
+    KeyEqual equal;
+    value_type *slots;
+    bool *used;
+    size_t cap;
+};
+
+/// Slots for trivially copyable, bitwise comparable keys and trivially
+/// copyable values: empty slots hold a sentinel key, keys are compared
+/// without branches, elements are moved with memcpy and never destroyed.
+template <typename Key, typename T, typename KeyEqual>
+class slot_array<Key, T, KeyEqual, true> {
+public:
+    struct slot {
+        Key key;
+        T value;
+    };
+
+    explicit slot_array(const Key &empty_key)
+        : slots(nullptr), cap(0), empty_key(empty_key), zero_sentinel(is_zero(empty_key)) {}
+    slot_array(const slot_array &other) = delete;
+    ~slot_array() { release(); }
+
+    void init(const size_t capacity) {
+        assert(slots == nullptr);
+        if (zero_sentinel) {
+            // fresh zeroed pages from the OS don't need to be written
+            slots = static_cast<slot*>(std::calloc(capacity, sizeof(slot)));
+        } else {
+            slots = static_cast<slot*>(std::malloc(capacity * sizeof(slot)));
+        }
+        if (slots == nullptr) throw std::bad_alloc();
+        cap = capacity;
+        if (!zero_sentinel) clear();
+    }
+
+    /// Free the memory, there is nothing to destroy
+    void release() {
+        std::free(slots);
+        slots = nullptr;
+        cap = 0;
+    }
+
+    void clear() {
+        if (zero_sentinel) {
+            std::memset(slots, 0, cap * sizeof(slot));
+            return;
+        }
+        for (size_t i = 0; i < cap; ++i) {
+            std::memcpy(&slots[i].key, &empty_key, sizeof(Key));
+        }
+    }
+
+    bool empty(const size_t i) const { return bitwise_equal(slots[i].key, empty_key); }
+    // holds(i, key) is true for empty slots if key is the sentinel
+    bool is_empty_key(const Key &key) const { return bitwise_equal(key, empty_key); }
+    bool holds(const size_t i, const Key &key) const { return bitwise_equal(slots[i].key, key); }
+
+    const Key& key(const size_t i) const { return slots[i].key; }
+    T& value(const size_t i) { return slots[i].value; }
+    const T& value(const size_t i) const { return slots[i].value; }
+
+    template <typename K>
+    void emplace(const size_t i, K &&key) {
+        assert(!bitwise_equal<Key>(key, empty_key));
+        slots[i].key = key;
+        slots[i].value = T{};
+    }
+
+    void erase(const size_t i) {
+        slots[i].key = empty_key;
+    }
+
+    /// Copy slot i of other into empty slot j. Slot i of other is left as is,
+    /// other is released after it was relocated completely.
+    void relocate(const slot_array &other, const size_t i, const size_t j) {
+        std::memcpy(&slots[j], &other.slots[i], sizeof(slot));
+    }
+
+    /// Move the element in slot i into empty slot j, slot i becomes empty
+    void shift(const size_t i, const size_t j) {
+        std::memcpy(&slots[j], &slots[i], sizeof(slot));
+        slots[i].key = empty_key;
+    }
+
+    void swap(slot_array &other) {
+        std::swap(slots, other.slots);
+        std::swap(cap, other.cap);
+    }
+
+protected:
+    static bool is_zero(const Key &key) {
+        const Key zero{};
+        return bitwise_equal(key, zero);
+    }
+
+    slot *slots;
+    size_t cap;
+    const Key empty_key;
+    const bool zero_sentinel;
+};
+
+}
+
+/// Open addressing with linear probing and backward shift deletion (no
+/// tombstones), at most half full. The slot layout is chosen at compile time
+/// based on the key and value types, see detail::slot_array. Keys and values
+/// with trivial slots use empty_key as a sentinel, it must not be inserted.
+/// Trivial slots compare keys bitwise, so a custom KeyEqual gets the generic
+/// ones.
+template <typename Key,
+          typename T,
+          typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>,
+          bool Trivial = has_trivial_slots<Key, T>::value &&
+                         std::is_same<KeyEqual, std::equal_to<Key>>::value>
+class open_addressing : public hashtable<Key, T> {
+    static_assert(!Trivial || std::is_same<KeyEqual, std::equal_to<Key>>::value,
+                  "trivial slots compare keys bitwise and would ignore KeyEqual");
+public:
+    open_addressing(const size_t bucket_count = 0, const Key empty_key = Key{})
+        : hashtable<Key, T>(), slots(empty_key), empty_key(empty_key), num(0)
+    {
+        allocate(capacity_for(bucket_count));
+    }
+    virtual ~open_addressing() = default;
+
+    // Register all contenders in the list
+    static void register_contenders(common::contender_list<hashtable<Key, T>> &list) {
+        using Factory = common::contender_factory<hashtable<Key, T>>;
+        list.register_contender(Factory("linear probing", "linear-probing",
+            [](){ return new open_addressing<Key, T, Hash, KeyEqual>(); }
+        ));
+        if (has_trivial_slots<Key, T>::value && std::is_same<KeyEqual, std::equal_to<Key>>::value) {
+            // to measure what the specialization for trivial slots gains
+            list.register_contender(Factory("linear probing with generic slots", "linear-probing-generic",
+                [](){ return new open_addressing<Key, T, Hash, KeyEqual, false>(); }
+            ));
+        }
+    }
+
+    T& operator[](const Key &key) override {
+        return slots.value(find_or_insert(key));
+    }
+
+    T& operator[](Key &&key) override {
+        return slots.value(find_or_insert(std::move(key)));
+    }
+
+    maybe<T> find(const Key &key) const override {
+        if (slots.is_empty_key(key)) return nothing<T>();
+        // Check for a hit first, it is the common case
+        for (size_t i = home(key); ; i = next(i)) {
+            if (slots.holds(i, key)) {
+                return just<T>(slots.value(i));
+            }
+            if (slots.empty(i)) {
+                return nothing<T>();
+            }
+        }
+    }
+
+    size_t erase(const Key &key) override {
+        if (slots.is_empty_key(key)) return 0;
+        size_t hole = home(key);
+        while (!slots.holds(hole, key)) {
+            if (slots.empty(hole)) return 0;
+            hole = next(hole);
+        }
+        slots.erase(hole);
+        --num;
+
+        // Move elements back into the hole unless that would move them
+        // before their home slot
+        for (size_t i = next(hole); !slots.empty(i); i = next(i)) {
+            const size_t h = home(slots.key(i));
+            if (((i - h) & mask) >= ((i - hole) & mask)) {
+                slots.shift(i, hole);
+                hole = i;
+            }
+        }
+        return 1;
+    }
+
+    size_t size() const override { return num; }
+
+    void clear() override {
+        slots.clear();
+        num = 0;
+    }
+
+    void for_each(const std::function<void(const Key&, T&)> &f) override {
+        for (size_t i = 0; i <= mask; ++i) {
+            if (!slots.empty(i)) f(slots.key(i), slots.value(i));
+        }
+    }
+
+    hashtable<Key, T>* create_empty() const override {
+        return new open_addressing(0, empty_key);
+    }
+
+    void merge_from(hashtable<Key, T> &&other, const typename hashtable<Key, T>::combiner &combine) override {
+        auto *o = dynamic_cast<open_addressing*>(&other);
+        if (o == nullptr || o == this) {
+            // Different type, use the generic implementation
+            hashtable<Key, T>::merge_from(std::move(other), combine);
+            return;
+        }
+        if (num == 0) {
+            // Nothing to combine, steal the other table's slots
+            slots.swap(o->slots);
+            std::swap(mask, o->mask);
+            std::swap(shift, o->shift);
+            std::swap(num, o->num);
+            return;
+        }
+        reserve(num + o->num);
+        for (size_t i = 0; i <= o->mask; ++i) {
+            if (o->slots.empty(i)) continue;
+            const size_t old_num = num;
+            const size_t pos = find_or_insert(o->slots.key(i));
+            if (num > old_num) {
+                slots.value(pos) = std::move(o->slots.value(i));
+            } else {
+                combine(slots.value(pos), std::move(o->slots.value(i)));
+            }
+        }
+        o->clear();
+    }
+
+    /// Make room for n elements without rehashing
+    void reserve(const size_t n) {
+        if (capacity_for(n) > mask + 1) rehash(capacity_for(n));
+    }
+
+protected:
+    using slot_array = detail::slot_array<Key, T, KeyEqual, Trivial>;
+
+    static size_t capacity_for(const size_t elements) {
+        size_t capacity = 16;
+        while (capacity < 2 * elements) capacity *= 2;
+        return capacity;
+    }
+
+    void allocate(const size_t capacity) {
+        slots.init(capacity);
+        mask = capacity - 1;
+        shift = 64 - __builtin_ctzll(capacity);
+    }
+
+    // Fibonacci hashing to spread out regular hash values
+    size_t home(const Key &key) const {
+        return (hasher(key) * 0x9E3779B97F4A7C15ull) >> shift;
+    }
+
+    size_t next(const size_t i) const {
+        return (i + 1) & mask;
+    }
+
+    template <typename K>
+    size_t find_or_insert(K &&key) {
+        assert(!slots.is_empty_key(key));
+        size_t i = home(key);
+        for (; !slots.holds(i, key); i = next(i)) {
+            if (slots.empty(i)) break;
+        }
+        if (!slots.empty(i)) return i;
+        if (2 * (num + 1) > mask + 1) {
+            rehash(2 * (mask + 1));
+            for (i = home(key); !slots.empty(i); i = next(i)) {}
+        }
+        slots.emplace(i, std::forward<K>(key));
+        ++num;
+        return i;
+    }
+
+    void rehash(const size_t capacity) {
+        slot_array old(empty_key);
+        old.swap(slots);
+        const size_t old_capacity = mask + 1;
+        allocate(capacity);
+        for (size_t i = 0; i < old_capacity; ++i) {
+            if (old.empty(i)) continue;
+            size_t pos = home(old.key(i));
+            while (!slots.empty(pos)) pos = next(pos);
+            slots.relocate(old, i, pos);
+        }
+    }
+
+    Hash hasher;
+    slot_array slots;
+    const Key empty_key;
+    size_t mask;
+    int shift;
+    size_t num;
+};
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include "key_traits.h"
+
+namespace hashtable {
+
+/// A 16-byte plain old data key type to measure the cost of wider keys
+struct pod16 {
+    uint64_t lo, hi;
+
+    pod16() = default;
+    // implicit so that benchmarks can use integer keys
+    pod16(const uint64_t x) : lo(x), hi(x * 0x9E3779B97F4A7C15ull) {}
+
+    bool operator==(const pod16 &other) const {
+        return lo == other.lo && hi == other.hi;
+    }
+    bool operator!=(const pod16 &other) const {
+        return !(*this == other);
+    }
+    bool operator<(const pod16 &other) const {
+        return lo < other.lo || (lo == other.lo && hi < other.hi);
+    }
+};
+
+static_assert(std::is_pod<pod16>::value && sizeof(pod16) == 16, "pod16 must be a 16-byte POD");
+
+template <>
+struct is_bitwise_comparable<pod16> : std::true_type {};
+
+}
+
+namespace std {
+template <>
+struct hash<hashtable::pod16> {
+    size_t operator()(const hashtable::pod16 &key) const {
+        return key.lo ^ (key.hi >> 32) ^ (key.hi << 32);
+    }
+};
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#include "../common/contenders.h"
+#include "../common/epoch.h"
+#include "hashtable.h"
+
+namespace hashtable {
+
+/// Open addressing hash table with linear probing for read-mostly tables.
+///
+/// find() is wait-free and may be called from any number of threads while a
+/// single writer performs all other operations. Slots are never reused within
+/// a table: erase() leaves a tombstone, and once elements and tombstones fill
+/// half of the table, the writer builds a new table and publishes it with one
+/// atomic store. Readers pin an epoch, so replaced tables are freed once no
+/// reader can still be probing them.
+///
+/// Values are written in place by the writer and loaded atomically by readers,
+/// so they must be small enough to be loaded without tearing. A value written
+/// through operator[] becomes visible as T{} first, use assign() to publish a
+/// new key together with its value.
+template <typename Key,
+          typename T,
+          typename Hash = std::hash<Key>>
+class rcu_hash_map : public hashtable<Key, T> {
+    static_assert(std::is_trivially_copyable<Key>::value &&
+                  std::is_trivially_copyable<T>::value,
+                  "rcu_hash_map requires trivially copyable keys and values");
+public:
+    rcu_hash_map(const size_t bucket_count = 0, const Key empty_key = Key{}, const Key deleted_key = static_cast<Key>(-1))
+        : hashtable<Key, T>(), empty_key(empty_key), deleted_key(deleted_key), live(0)
+    {
+        assert(empty_key != deleted_key);
+        current.store(new table(capacity_for(bucket_count), empty_key),
+                      std::memory_order_relaxed);
+    }
+
+    virtual ~rcu_hash_map() {
+        delete current.load(std::memory_order_relaxed);
+    }
+
+    // Register all contenders in the list
+    static void register_contenders(common::contender_list<hashtable<Key, T>> &list) {
+        // Readers need lock-free atomic loads of keys and values
+        register_contenders(list, std::integral_constant<bool,
+            sizeof(Key) <= sizeof(uint64_t) && sizeof(T) <= sizeof(uint64_t)>());
+    }
+
+    T& operator[](const Key &key) override {
+        return find_or_insert(key, T{}).value;
+    }
+
+    T& operator[](Key &&key) override {
+        return find_or_insert(key, T{}).value;
+    }
+
+    /// Set the value of a key so that readers never observe a default value
+    void assign(const Key &key, const T &value) {
+        slot &s = find_or_insert(key, value);
+        __atomic_store(&s.value, &value, __ATOMIC_RELAXED);
+    }
+
+    maybe<T> find(const Key &key) const override {
+        // The sentinels are never stored, but the probe would match a free
+        // slot or a tombstone
+        if (key == empty_key || key == deleted_key) return nothing<T>();
+        common::epoch_manager::guard guard(epochs);
+        const table *t = current.load(std::memory_order_seq_cst);
+        for (size_t pos = t->home(hasher(key)); ; pos = (pos + 1) & t->mask) {
+            const slot &s = t->slots[pos];
+            const Key k = s.key.load(std::memory_order_acquire);
+            if (k == key) {
+                T value;
+                __atomic_load(&s.value, &value, __ATOMIC_RELAXED);
+                return just<T>(value);
+            }
+            if (k == empty_key) {
+                return nothing<T>();
+            }
+        }
+    }
+
+    size_t erase(const Key &key) override {
+        if (key == empty_key || key == deleted_key) return 0;
+        table *t = current.load(std::memory_order_relaxed);
+        for (size_t pos = t->home(hasher(key)); ; pos = (pos + 1) & t->mask) {
+            slot &s = t->slots[pos];
+            const Key k = s.key.load(std::memory_order_relaxed);
+            if (k == key) {
+                s.key.store(deleted_key, std::memory_order_release);
+                live.store(live.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                return 1;
+            }
+            if (k == empty_key) {
+                return 0;
+            }
+        }
+    }
+
+    size_t size() const override { return live.load(std::memory_order_relaxed); }
+
+    void clear() override {
+        publish(new table(capacity_for(0), empty_key));
+        live.store(0, std::memory_order_relaxed);
+    }
+
+    void for_each(const std::function<void(const Key&, T&)> &f) override {
+        table *t = current.load(std::memory_order_relaxed);
+        for (size_t pos = 0; pos <= t->mask; ++pos) {
+            slot &s = t->slots[pos];
+            const Key k = s.key.load(std::memory_order_relaxed);
+            if (k != empty_key && k != deleted_key) {
+                f(k, s.value);
+            }
+        }
+    }
+
+    bool concurrent_find() const override { return true; }
+
+    hashtable<Key, T>* create_empty() const override {
+        return new rcu_hash_map(0, empty_key, deleted_key);
+    }
+
+protected:
+    static void register_contenders(common::contender_list<hashtable<Key, T>> &list, std::true_type) {
+        using Factory = common::contender_factory<hashtable<Key, T>>;
+        list.register_contender(Factory("RCU hash map", "rcu-hash-map",
+            [](){ return new rcu_hash_map<Key, T>(); }
+        ));
+    }
+
+    static void register_contenders(common::contender_list<hashtable<Key, T>> &, std::false_type) {}
+
+    struct slot {
+        std::atomic<Key> key;
+        T value;
+    };
+
+    struct table {
+        table(const size_t capacity, const Key &empty_key)
+            : mask(capacity - 1)
+            , shift(64 - __builtin_ctzll(capacity))
+            , occupied(0)
+            , slots(new slot[capacity])
+        {
+            assert((capacity & mask) == 0);
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].key.store(empty_key, std::memory_order_relaxed);
+            }
+        }
+
+        // Fibonacci hashing to spread out regular hash values
+        size_t home(const size_t hash) const {
+            return (hash * 0x9E3779B97F4A7C15ull) >> shift;
+        }
+
+        const size_t mask;
+        const int shift;
+        size_t occupied; // elements + tombstones, only used by the writer
+        std::unique_ptr<slot[]> slots;
+    };
+
+    static size_t capacity_for(const size_t elements) {
+        size_t capacity = 16;
+        while (capacity < 4 * elements) capacity *= 2;
+        return capacity;
+    }
+
+    slot& find_or_insert(const Key &key, const T &init) {
+        assert(key != empty_key && key != deleted_key);
+        table *t = current.load(std::memory_order_relaxed);
+        size_t pos = t->home(hasher(key));
+        while (true) {
+            slot &s = t->slots[pos];
+            const Key k = s.key.load(std::memory_order_relaxed);
+            if (k == key) return s;
+            if (k == empty_key) break;
+            pos = (pos + 1) & t->mask;
+        }
+
+        const size_t num = live.load(std::memory_order_relaxed);
+        if (2 * (t->occupied + 1) > t->mask + 1) {
+            t = rebuild(num + 1);
+            pos = t->home(hasher(key));
+            while (t->slots[pos].key.load(std::memory_order_relaxed) != empty_key) {
+                pos = (pos + 1) & t->mask;
+            }
+        }
+
+        // Publish the value before the key
+        slot &s = t->slots[pos];
+        s.value = init;
+        s.key.store(key, std::memory_order_release);
+        ++t->occupied;
+        live.store(num + 1, std::memory_order_relaxed);
+        return s;
+    }
+
+    // Copy all elements into a new table that has room for elements, drop
+    // the tombstones, and publish it
+    table* rebuild(const size_t elements) {
+        const table *old = current.load(std::memory_order_relaxed);
+        table *t = new table(capacity_for(elements), empty_key);
+        for (size_t i = 0; i <= old->mask; ++i) {
+            const slot &s = old->slots[i];
+            const Key k = s.key.load(std::memory_order_relaxed);
+            if (k == empty_key || k == deleted_key) continue;
+
+            size_t pos = t->home(hasher(k));
+            while (t->slots[pos].key.load(std::memory_order_relaxed) != empty_key) {
+                pos = (pos + 1) & t->mask;
+            }
+            t->slots[pos].value = s.value;
+            t->slots[pos].key.store(k, std::memory_order_relaxed);
+            ++t->occupied;
+        }
+        publish(t);
+        return t;
+    }
+
+    void publish(table *t) {
+        table *old = current.load(std::memory_order_relaxed);
+        current.store(t, std::memory_order_seq_cst);
+        epochs.retire(old);
+        epochs.reclaim();
+    }
+
+    Hash hasher;
+    const Key empty_key, deleted_key;
+    std::atomic<size_t> live;
+    std::atomic<table*> current;
+    mutable common::epoch_manager epochs;
+};
+
+}
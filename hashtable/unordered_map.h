@@ -52,6 +52,26 @@ public:
 
     void clear() override { map.clear(); }
 
+    void for_each(const std::function<void(const Key&, T&)> &f) override {
+        for (auto &entry : map) {
+            f(entry.first, entry.second);
+        }
+    }
+
+    hashtable<Key, T>* create_empty() const override {
+        return new unordered_map();
+    }
+
+    void merge_from(hashtable<Key, T> &&other, const typename hashtable<Key, T>::combiner &combine) override {
+        auto *o = dynamic_cast<unordered_map*>(&other);
+        if (o == nullptr) {
+            // Different type, use the generic implementation
+            hashtable<Key, T>::merge_from(std::move(other), combine);
+            return;
+        }
+        merge_maps(map, o->map, combine, [this](const size_t n) { map.reserve(n); });
+    }
+
 protected:
     std::unordered_map<Key, T, Hash, KeyEqual, Allocator> map;
 };
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../common/benchmark.h"
 #include "../common/contenders.h"
@@ -17,6 +20,8 @@ public:
     using Configuration = std::pair<size_t, size_t>;
     using Benchmark = common::benchmark<HashTable, Configuration>;
     using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using Key = typename HashTable::key_type;
+    using T = typename HashTable::mapped_type;
 
     // fake word count, doesn't actually determine the most frequent
     // words because our hashtables don't have an iterator interface
@@ -28,6 +33,37 @@ public:
         }
     }
 
+    // read the word file encoded in config and map each word to a Key
+    static std::vector<Key>* load_words(Configuration config) {
+        // awful hack approaching
+        std::stringstream fn;
+        // convert encoded filename back to ascii
+        fn << "data/wordcount_" << common::util::hex_to_ascii(config.first);
+        if (config.second > 0)
+            fn << "_" << common::util::hex_to_ascii(config.second);
+        fn << ".txt";
+
+        std::ifstream in(fn.str());
+        if (!in.is_open())
+            throw std::invalid_argument("Cannot open file '" + fn.str() + "'.");
+
+        // map strings to key type because stupid benchmark
+        std::unordered_map<std::string, Key> ids;
+        ids[""] = Key{}; // dummy to use key Key{}
+        auto words = new std::vector<Key>();
+
+        std::string word;
+        while (in >> word) {
+            Key& key = ids[word];
+            if (key == Key{}) {
+                key = static_cast<Key>(ids.size());
+            }
+            words->push_back(key);
+        }
+
+        return words;
+    }
+
     static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
         // HACKHACKHACK
         const std::vector<Configuration> configs{
@@ -35,38 +71,9 @@ public:
             std::make_pair(0x5368616b657370, 0x636f6d706c657465) // "Shakesp", "complete"
         };
 
-        using Key = typename HashTable::key_type;
-
         common::register_benchmark("wordcount", "wordcount",
             [](HashTable&, Configuration config, void*) -> void* {
-                // awful hack approaching
-                std::stringstream fn;
-                // convert encoded filename back to ascii
-                fn << "data/wordcount_" << common::util::hex_to_ascii(config.first);
-                if (config.second > 0)
-                    fn << "_" << common::util::hex_to_ascii(config.second);
-                fn << ".txt";
-
-                std::ifstream in(fn.str());
-                if (!in.is_open())
-                    throw std::invalid_argument("Cannot open file '" + fn.str() + "'.");
-
-                // map strings to key type because stupid benchmark
-                std::unordered_map<std::string, Key> ids;
-                ids[""] = Key{}; // dummy to use key Key{}
-                auto words = new std::vector<Key>();
-
-                std::string word;
-                while (in >> word) {
-                    Key& key = ids[word];
-                    if (key == Key{}) {
-                        key = static_cast<Key>(ids.size());
-                    }
-                    words->push_back(key);
-                }
-
-                // Allocate data array and copy
-                return words;
+                return wordcount::load_words(config);
             },
             [](HashTable &map, Configuration, void* ptr) {
                 assert(ptr != nullptr);
@@ -76,6 +83,44 @@ public:
             [](HashTable &, Configuration, void* ptr) {
                 delete static_cast<std::vector<Key>*>(ptr);
             }, configs, benchmarks);
+
+        // Merge the partial counts of P workers that each counted a
+        // contiguous chunk of the text. Only the merge is timed.
+        for (size_t num_partials : {2, 8, 32}) {
+            common::register_benchmark(
+                "wordcount merge P=" + std::to_string(num_partials),
+                "wordcount-merge-" + std::to_string(num_partials),
+                [num_partials](HashTable &map, Configuration config, void*) -> void* {
+                    auto words = wordcount::load_words(config);
+                    auto partials = new std::vector<HashTable*>();
+                    const size_t chunk = (words->size() + num_partials - 1) / num_partials;
+                    for (size_t i = 0; i < num_partials; ++i) {
+                        HashTable *partial = map.create_empty();
+                        auto begin = words->begin() + std::min(i * chunk, words->size());
+                        auto end = words->begin() + std::min((i + 1) * chunk, words->size());
+                        wordcount::count(*partial, begin, end);
+                        partials->push_back(partial);
+                    }
+                    delete words;
+                    return partials;
+                },
+                [](HashTable &map, Configuration, void* ptr) {
+                    assert(ptr != nullptr);
+                    auto partials = static_cast<std::vector<HashTable*>*>(ptr);
+                    for (HashTable *partial : *partials) {
+                        map.merge_from(std::move(*partial), [](T &ours, T &&theirs) {
+                            ours += theirs;
+                        });
+                    }
+                },
+                [](HashTable &, Configuration, void* ptr) {
+                    auto partials = static_cast<std::vector<HashTable*>*>(ptr);
+                    for (HashTable *partial : *partials) {
+                        delete partial;
+                    }
+                    delete partials;
+                }, configs, benchmarks);
+        }
     }
 
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <utility>
+
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Priority queue whose elements can be changed or removed after they were
+/// pushed, through handles returned by insert. Implement insert, decrease_key
+/// and erase in addition to pop, top and size; push is insert without the
+/// handle.
+template <typename T>
+class addressable_priority_queue : public priority_queue<T> {
+public:
+    /// Opaque reference to an element, valid until the element is popped or
+    /// erased
+    using handle = void*;
+
+    // You also need to provide the following:
+    // static void register_contenders(common::contender_list<priority_queue<T>> &list)
+
+    /// Add an element by const lvalue reference and return a handle to it
+    virtual handle insert(const T& value) = 0;
+    /// Add an element by rvalue reference (with move) and return a handle to it
+    virtual handle insert(T&& value) = 0;
+
+    /// Replace an element by value, which must not be ordered before it, so
+    /// that the element moves towards the top. The queues are max-heaps, so
+    /// with the default comparison value is at least as large as the element.
+    /// This is decrease-key for priorities where smaller keys come first,
+    /// such as distances in Dijkstra's algorithm stored negated.
+    virtual void decrease_key(handle h, const T& value) = 0;
+
+    /// Remove an element
+    virtual void erase(handle h) = 0;
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        insert(value);
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        insert(std::move(value));
+    }
+};
+
+}
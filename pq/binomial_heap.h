@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "../common/node_pool.h"
+#include "addressable_priority_queue.h"
+
+namespace pq {
+
+/// Binomial heap (Vuillemin 1978) as a max-heap. The roots form a list of
+/// binomial trees of strictly increasing degree, like the bits of a binary
+/// number, and insert links trees of equal degree like a carry. pop merges
+/// the children of the largest root back into the list.
+///
+/// decrease_key moves values up the tree instead of relinking nodes, so
+/// handles point to small items that follow their value from node to node.
+/// Nodes and items come from pools, and the destructor is iterative.
+template <typename T,
+          typename Compare = std::less<T>>
+class binomial_heap : public addressable_priority_queue<T> {
+public:
+    using handle = typename addressable_priority_queue<T>::handle;
+
+    binomial_heap() : head(nullptr), max(nullptr), num(0) {}
+    binomial_heap(const binomial_heap&) = delete;
+
+    virtual ~binomial_heap() {
+        destroy_all();
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("binomial heap", "binomial-heap",
+            [](){ return new binomial_heap<T>(); }
+        ));
+    }
+
+    /// Add an element by const lvalue reference and return a handle to it
+    handle insert(const T& value) override {
+        return add(nodes.create(value));
+    }
+    /// Add an element by rvalue reference (with move) and return a handle to it
+    handle insert(T&& value) override {
+        return add(nodes.create(std::move(value)));
+    }
+
+    /// Move an element towards the top by replacing it with value
+    void decrease_key(handle h, const T& value) override {
+        node *n = static_cast<item*>(h)->position;
+        assert(!comp(value, n->value));
+        n->value = value;
+        n = sift_up(n, false);
+        if (n->parent == nullptr && comp(max->value, n->value)) max = n;
+    }
+
+    /// Remove an element
+    void erase(handle h) override {
+        node *n = static_cast<item*>(h)->position;
+        remove_root(sift_up(n, true));
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        remove_root(max);
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return max->value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new binomial_heap();
+    }
+
+    /// Move all elements of other into this heap, in logarithmic time if it
+    /// is a binomial heap of the same type. Handles into other stay valid.
+    void meld(priority_queue<T> &&other) override {
+        auto *o = dynamic_cast<binomial_heap*>(&other);
+        if (o == nullptr || o == this) {
+            priority_queue<T>::meld(std::move(other));
+            return;
+        }
+        if (o->max != nullptr && (max == nullptr || comp(max->value, o->max->value))) {
+            max = o->max;
+        }
+        head = merge(head, o->head);
+        // An equal element may have won a link against the maximum
+        if (max != nullptr) {
+            while (max->parent != nullptr) max = max->parent;
+        }
+        num += o->num;
+        nodes.absorb(o->nodes);
+        items.absorb(o->items);
+        o->head = o->max = nullptr;
+        o->num = 0;
+    }
+
+protected:
+    struct node;
+
+    // What a handle points to
+    struct item {
+        node *position;
+    };
+
+    struct node {
+        template <typename V>
+        explicit node(V &&value)
+            : value(std::forward<V>(value)), owner(nullptr), parent(nullptr),
+              child(nullptr), sibling(nullptr), degree(0) {}
+
+        T value;
+        item *owner;
+        node *parent;
+        node *child;   // child of the highest degree
+        node *sibling; // next root of higher degree, or next child of lower degree
+        unsigned degree;
+    };
+
+    handle add(node *n) {
+        item *i = items.create();
+        i->position = n;
+        n->owner = i;
+        if (max == nullptr || comp(max->value, n->value)) max = n;
+        // Link trees of equal degree like adding one to a binary number
+        node *carry = n;
+        while (head != nullptr && head->degree == carry->degree) {
+            node *next = head->sibling;
+            carry = link(carry, head);
+            head = next;
+        }
+        carry->sibling = head;
+        head = carry;
+        // An equal element may have won a link against the maximum
+        while (max->parent != nullptr) max = max->parent;
+        ++num;
+        return i;
+    }
+
+    // Make the root with the smaller value a child of the other one
+    node* link(node *a, node *b) {
+        if (comp(a->value, b->value)) std::swap(a, b);
+        b->parent = a;
+        b->sibling = a->child;
+        a->child = b;
+        ++a->degree;
+        return a;
+    }
+
+    // Move a value up while it is larger than its parent's, or up to the
+    // root if always is set. Returns the node that holds it in the end.
+    node* sift_up(node *n, const bool always) {
+        while (n->parent != nullptr && (always || comp(n->parent->value, n->value))) {
+            node *p = n->parent;
+            std::swap(n->value, p->value);
+            std::swap(n->owner, p->owner);
+            n->owner->position = n;
+            p->owner->position = p;
+            n = p;
+        }
+        return n;
+    }
+
+    // Merge two root lists sorted by degree and link trees of equal degree
+    node* merge(node *a, node *b) {
+        node *first = nullptr, **tail = &first;
+        while (a != nullptr && b != nullptr) {
+            node *&smaller = (a->degree <= b->degree) ? a : b;
+            *tail = smaller;
+            tail = &smaller->sibling;
+            smaller = smaller->sibling;
+        }
+        *tail = (a != nullptr) ? a : b;
+
+        if (first == nullptr) return nullptr;
+        node *prev = nullptr, *x = first, *next = x->sibling;
+        while (next != nullptr) {
+            if (x->degree != next->degree ||
+                    (next->sibling != nullptr && next->sibling->degree == x->degree)) {
+                // At most two trees of a degree remain, link the last two
+                prev = x;
+                x = next;
+            } else {
+                node *after = next->sibling;
+                x = link(x, next);
+                x->sibling = after;
+                if (prev == nullptr) {
+                    first = x;
+                } else {
+                    prev->sibling = x;
+                }
+            }
+            next = x->sibling;
+        }
+        return first;
+    }
+
+    // Remove and destroy a root and find the new maximum
+    void remove_root(node *r) {
+        assert(r->parent == nullptr);
+        node **link_to_r = &head;
+        while (*link_to_r != r) link_to_r = &(*link_to_r)->sibling;
+        *link_to_r = r->sibling;
+
+        // The children are sorted by decreasing degree
+        node *children = nullptr;
+        for (node *c = r->child; c != nullptr; ) {
+            node *next = c->sibling;
+            c->parent = nullptr;
+            c->sibling = children;
+            children = c;
+            c = next;
+        }
+        head = merge(head, children);
+
+        items.destroy(r->owner);
+        nodes.destroy(r);
+        --num;
+
+        max = head;
+        for (node *n = head; n != nullptr; n = n->sibling) {
+            if (comp(max->value, n->value)) max = n;
+        }
+    }
+
+    // Destroy all elements without recursion. The pools free the memory.
+    void destroy_all() {
+        if (std::is_trivially_destructible<T>::value || head == nullptr) return;
+        std::vector<node*> stack{head};
+        while (!stack.empty()) {
+            node *n = stack.back();
+            stack.pop_back();
+            if (n->child != nullptr) stack.push_back(n->child);
+            if (n->sibling != nullptr) stack.push_back(n->sibling);
+            nodes.destroy(n);
+        }
+    }
+
+    Compare comp;
+    common::node_pool<node> nodes;
+    common::node_pool<item> items;
+    node *head; // root of the lowest degree
+    node *max;
+    size_t num;
+};
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "../common/node_pool.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Hierarchical bitset for unsigned integers of up to 32 bits as a max-heap,
+/// a 64-ary trie in the spirit of a van Emde Boas tree. Every node has a
+/// 64-bit word with a bit for each nonempty child, the root takes the top 2
+/// bits of the key and the levels below 6 bits each. push and pop follow a
+/// path of 6 nodes, and the largest child of a node is found with one lzcnt.
+///
+/// A flat bitset over all 2^32 keys would take 512 MiB, so nodes are only
+/// allocated when they are needed and store their children in an array in
+/// the order of their bits. The index of a child is the popcount of the
+/// bits below its own, and the largest child is the last one, so pop only
+/// removes children from the back. The last level stores the 64-bit words of
+/// the leaves in its array instead of pointers. Keys that are pushed more
+/// than once are counted in a hash table.
+template <typename T>
+class bitset_queue : public priority_queue<T> {
+    static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value && sizeof(T) <= 4,
+                  "bitset_queue needs unsigned integers of at most 32 bits");
+    // Levels of inner nodes, the root's digit starts at bit 30
+    static constexpr int levels = 5;
+public:
+    bitset_queue() : num(0), top_value() {}
+    bitset_queue(const bitset_queue&) = delete;
+
+    virtual ~bitset_queue() {
+        destroy_children(root, 0);
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("hierarchical bitset queue", "bitset-queue",
+            [](){ return new bitset_queue<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        const uint32_t key = value;
+        node *n = &root;
+        for (int level = 0; level < levels - 1; ++level) {
+            const size_t index = child_index(*n, digit(key, level));
+            if (n->children[index] == 0) {
+                n->children[index] = reinterpret_cast<uint64_t>(pool.create());
+            }
+            n = reinterpret_cast<node*>(n->children[index]);
+        }
+        uint64_t &leaf = n->children[child_index(*n, digit(key, levels - 1))];
+        const uint64_t bit = uint64_t(1) << (key & 63);
+        if (leaf & bit) {
+            ++duplicates[key];
+        } else {
+            leaf |= bit;
+        }
+        ++num;
+    }
+    /// Add an element by rvalue reference, which is the same for integers
+    void push(T&& value) override {
+        push(static_cast<const T&>(value));
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        --num;
+        // Follow the largest children down to the leaf
+        node *path[levels];
+        path[0] = &root;
+        uint32_t key = 0;
+        for (int level = 0; level < levels - 1; ++level) {
+            key |= highest(path[level]->bits) << shift(level);
+            path[level + 1] = reinterpret_cast<node*>(path[level]->children.back());
+        }
+        uint64_t &leaf = path[levels - 1]->children.back();
+        key |= highest(path[levels - 1]->bits) << shift(levels - 1) | highest(leaf);
+
+        if (!duplicates.empty()) {
+            auto it = duplicates.find(key);
+            if (it != duplicates.end()) {
+                if (--it->second == 0) duplicates.erase(it);
+                return;
+            }
+        }
+        leaf &= ~(uint64_t(1) << highest(leaf));
+        if (leaf != 0) return;
+        // Remove children that became empty, from the bottom up
+        for (int level = levels - 1; level >= 0; --level) {
+            node *n = path[level];
+            n->children.pop_back();
+            n->bits &= ~(uint64_t(1) << highest(n->bits));
+            if (n->bits != 0 || level == 0) return;
+            pool.destroy(n);
+        }
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        const node *n = &root;
+        uint32_t key = 0;
+        for (int level = 0; level < levels - 1; ++level) {
+            key |= highest(n->bits) << shift(level);
+            n = reinterpret_cast<const node*>(n->children.back());
+        }
+        key |= highest(n->bits) << shift(levels - 1) | highest(n->children.back());
+        top_value = static_cast<T>(key);
+        return top_value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new bitset_queue();
+    }
+
+protected:
+    struct node {
+        node() : bits(0) {}
+        uint64_t bits;
+        // Child pointers, or the leaves' words on the last level, in the
+        // order of their bits
+        std::vector<uint64_t> children;
+    };
+
+    static constexpr int shift(const int level) {
+        return 30 - 6 * level;
+    }
+
+    static uint32_t digit(const uint32_t key, const int level) {
+        return (key >> shift(level)) & 63;
+    }
+
+    static uint32_t highest(const uint64_t bits) {
+        return 63 - __builtin_clzll(bits);
+    }
+
+    // Index of the child with the given digit, which is added as an empty
+    // entry if it doesn't exist
+    static size_t child_index(node &n, const uint32_t d) {
+        const uint64_t bit = uint64_t(1) << d;
+        const size_t index = __builtin_popcountll(n.bits & (bit - 1));
+        if (!(n.bits & bit)) {
+            n.bits |= bit;
+            n.children.insert(n.children.begin() + index, 0);
+        }
+        return index;
+    }
+
+    void destroy_children(node &n, const int level) {
+        if (level == levels - 1) return;
+        for (const uint64_t child : n.children) {
+            node *c = reinterpret_cast<node*>(child);
+            destroy_children(*c, level + 1);
+            pool.destroy(c);
+        }
+    }
+
+    common::node_pool<node> pool;
+    node root;
+    std::unordered_map<uint32_t, size_t> duplicates; // copies beyond the first
+    size_t num;
+    T top_value;
+};
+
+template <typename T>
+constexpr int bitset_queue<T>::levels;
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Priority queue that can be limited to a number of elements. Once it is
+/// full, a push keeps the elements that would be popped last: the new
+/// element replaces the top if it is ordered before it and is dropped
+/// otherwise. With the default comparison, a bounded max-heap thus keeps
+/// the k smallest elements it was given, and its top is the k-th smallest.
+/// Benchmarks find out whether a contender supports it with a dynamic_cast,
+/// like for addressable queues.
+template <typename T>
+class bounded_priority_queue : public priority_queue<T> {
+public:
+    // You also need to provide the following:
+    // static void register_contenders(common::contender_list<priority_queue<T>> &list)
+
+    /// Keep at most k elements from now on, popping the top elements if
+    /// there are more. Queues are unbounded until this is called.
+    virtual void bound(size_t k) = 0;
+};
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "dary_heap.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Bucket queue (Dial 1969) for integer keys as a max-heap. A circular
+/// array counts the elements of every key in a window of range consecutive
+/// keys, and a bitmap of the nonempty buckets finds the next smaller key 64
+/// buckets at a time. push takes constant time, and pop amortized constant
+/// time if the keys come from a small range, or decrease in small steps like
+/// negated distances in Dijkstra's algorithm with small edge weights.
+///
+/// The window follows the elements. A key outside of it moves the window
+/// if the elements and the key fit into range keys, otherwise it goes to a
+/// d-ary heap, so that the queue stays correct for any workload.
+template <typename T>
+class bucket_queue : public priority_queue<T> {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 4,
+                  "bucket_queue needs integer keys of at most 32 bits");
+public:
+    explicit bucket_queue(const size_t range)
+        : range(round_up(range)), counts(this->range, 0), occupied(this->range / 64, 0),
+          low(0), max_key(0), min_key(0), in_buckets(0), top_value() {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        for (const size_t range : {size_t(1) << 10, size_t(1) << 16}) {
+            list.register_contender(Factory(
+                "bucket queue, " + std::to_string(range) + " keys",
+                "bucket-queue-" + std::to_string(range),
+                [range](){ return new bucket_queue<T>(range); }
+            ));
+        }
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        const int64_t key = value;
+        if (in_buckets == 0) {
+            // Center the window on the first key
+            low = key - static_cast<int64_t>(range / 2);
+            max_key = min_key = key;
+        } else if (key < low || key >= low + static_cast<int64_t>(range)) {
+            const int64_t lo = std::min(key, min_key), hi = std::max(key, max_key);
+            if (hi - lo >= static_cast<int64_t>(range)) {
+                fallback.push(value);
+                return;
+            }
+            // Leave as much room as possible beyond the new key
+            low = (key < low) ? hi - static_cast<int64_t>(range) + 1 : lo;
+        }
+        const size_t index = key & (range - 1);
+        if (counts[index]++ == 0) {
+            occupied[index / 64] |= uint64_t(1) << (index % 64);
+        }
+        max_key = std::max(max_key, key);
+        min_key = std::min(min_key, key);
+        ++in_buckets;
+    }
+    /// Add an element to the priority queue by rvalue reference, which is
+    /// the same for integers
+    void push(T&& value) override {
+        push(static_cast<const T&>(value));
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        if (top_in_fallback()) {
+            fallback.pop();
+            return;
+        }
+        const size_t index = max_key & (range - 1);
+        --in_buckets;
+        if (--counts[index] == 0) {
+            occupied[index / 64] &= ~(uint64_t(1) << (index % 64));
+            if (in_buckets > 0) max_key -= distance_to_next(index);
+        }
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        if (top_in_fallback()) return fallback.top();
+        top_value = static_cast<T>(max_key);
+        return top_value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return in_buckets + fallback.size();
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new bucket_queue(range);
+    }
+
+protected:
+    // The next power of two, at least one word of the bitmap
+    static size_t round_up(const size_t range) {
+        size_t result = 64;
+        while (result < range) result *= 2;
+        return result;
+    }
+
+    bool top_in_fallback() {
+        return in_buckets == 0 ||
+            (fallback.size() > 0 && max_key < static_cast<int64_t>(fallback.top()));
+    }
+
+    // Distance to the next nonempty bucket below index, wrapping around.
+    // There must be one.
+    size_t distance_to_next(const size_t index) const {
+        size_t word = index / 64;
+        uint64_t bits = occupied[word] & ((uint64_t(1) << (index % 64)) - 1);
+        while (bits == 0) {
+            word = (word == 0 ? occupied.size() : word) - 1;
+            bits = occupied[word];
+        }
+        const size_t found = word * 64 + 63 - __builtin_clzll(bits);
+        return (index - found) & (range - 1);
+    }
+
+    const size_t range; // a power of two
+    std::vector<size_t> counts;
+    std::vector<uint64_t> occupied; // bitmap of the nonempty buckets
+    int64_t low;                    // smallest key of the window
+    int64_t max_key, min_key;       // bounds of the keys in buckets
+    size_t in_buckets;
+    T top_value;
+    dary_heap<T> fallback;
+};
+
+}
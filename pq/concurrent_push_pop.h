@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+
+namespace pq {
+
+template <typename PQ>
+class concurrent_push_pop {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+
+    // Operations per element initially in the queue, over all threads
+    static constexpr size_t ops_per_element = 4;
+
+    // A push or successful pop, pushes are stamped before they start and pops
+    // after they finish, so that a pop comes after the push of its element
+    struct event {
+        uint64_t time;
+        T value;
+        bool push;
+    };
+    // One event log per thread and a last one for the initial elements
+    using logs = std::vector<std::vector<event>>;
+
+    /// Fill the queue with config.first random elements and allocate the
+    /// threads' event logs, so that the run doesn't page fault on them
+    static void* fill(PQ &queue, Configuration config, const size_t num_threads) {
+        std::mt19937 random{config.second};
+        logs *l = new logs(num_threads + 1);
+        for (size_t t = 0; t < num_threads; ++t) {
+            (*l)[t].resize(ops_per_element * config.first / num_threads);
+        }
+        for (size_t i = 0; i < config.first; ++i) {
+            const T value = static_cast<T>(random());
+            queue.push(value);
+            l->back().push_back(event{0, value, true});
+        }
+        return l;
+    }
+
+    /// Run threads that each push a random element or pop an element with
+    /// equal probability. The total number of operations is independent of
+    /// the number of threads, so the running time is inversely proportional
+    /// to the throughput. Queues that do not support concurrent access are
+    /// protected by a lock.
+    static void run(PQ &queue, Configuration config, void* data, const size_t num_threads) {
+        logs &l = *static_cast<logs*>(data);
+        const size_t ops_per_thread = ops_per_element * config.first / num_threads;
+        const bool locked = !queue.concurrent();
+        std::mutex mutex;
+
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                // xorshift, cheap compared to a queue operation
+                uint64_t state = config.second + 0x9E3779B97F4A7C15ull * (t + 1);
+                std::vector<event> &events = l[t];
+                size_t used = 0;
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                    if (state & 1) {
+                        const T value = static_cast<T>(state >> 1);
+                        events[used++] = event{now(), value, true};
+                        if (locked) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            queue.push(value);
+                        } else {
+                            queue.push(value);
+                        }
+                    } else {
+                        T value;
+                        bool popped;
+                        if (locked) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            popped = queue.try_pop(value);
+                        } else {
+                            popped = queue.try_pop(value);
+                        }
+                        if (popped) events[used++] = event{now(), value, false};
+                    }
+                }
+                events.resize(used);
+            });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    /// Replay the threads' events in the order of their time stamps and print
+    /// the rank error of the popped elements, i.e., how many larger elements
+    /// were in the queue when they were popped
+    static void report_rank_error(Configuration config, void* data, const size_t num_threads) {
+        logs *l = static_cast<logs*>(data);
+        std::vector<event> events;
+        for (auto &log : *l) {
+            events.insert(events.end(), log.begin(), log.end());
+        }
+        delete l;
+        std::stable_sort(events.begin(), events.end(), [](const event &a, const event &b) {
+            return a.time < b.time || (a.time == b.time && a.push && !b.push);
+        });
+
+        // Count the elements in the queue by their index among all values in
+        // a Fenwick tree, so that ranks take logarithmic time
+        std::vector<T> values;
+        for (const event &e : events) {
+            if (e.push) values.push_back(e.value);
+        }
+        std::sort(values.begin(), values.end());
+        values.erase(std::unique(values.begin(), values.end()), values.end());
+        std::vector<size_t> tree(values.size() + 1, 0);
+        // Pops whose push got a later time stamp on another core remove the
+        // element when the push comes
+        std::vector<size_t> owed(values.size(), 0);
+        size_t num = 0, pops = 0, max_rank = 0;
+        double sum_rank = 0;
+
+        for (const event &e : events) {
+            const size_t index = std::lower_bound(values.begin(), values.end(), e.value) - values.begin();
+            if (e.push) {
+                if (owed[index] > 0) {
+                    --owed[index];
+                    continue;
+                }
+                for (size_t i = index + 1; i < tree.size(); i += i & -i) ++tree[i];
+                ++num;
+            } else {
+                // Number of elements that are at most as large as the popped one
+                size_t at_most = 0;
+                for (size_t i = index + 1; i > 0; i -= i & -i) at_most += tree[i];
+                size_t count = at_most;
+                for (size_t i = index; i > 0; i -= i & -i) count -= tree[i];
+                if (count == 0) {
+                    ++owed[index];
+                } else {
+                    for (size_t i = index + 1; i < tree.size(); i += i & -i) --tree[i];
+                    const size_t rank = num - at_most;
+                    sum_rank += rank;
+                    max_rank = std::max(max_rank, rank);
+                    --num;
+                }
+                ++pops;
+            }
+        }
+
+        std::cout << "\tRank error of " << pops << " pops on " << config.first << " elements with "
+                  << num_threads << " threads: mean " << (pops > 0 ? sum_rank / pops : 0)
+                  << ", max " << max_rank << std::endl;
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<16, 0xDECAF),
+            std::make_pair(1<<20, 0xC0FFEE),
+        };
+
+        // Scale the number of threads from 1 to the number of cores
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<size_t> thread_counts;
+        for (size_t threads = 1; threads < cores; threads *= 2) {
+            thread_counts.push_back(threads);
+        }
+        thread_counts.push_back(cores);
+
+        for (size_t threads : thread_counts) {
+            common::register_benchmark(
+                "concurrent push-pop mix, " + std::to_string(threads) + " threads",
+                "concurrent-push-pop-" + std::to_string(threads),
+                [threads](PQ &queue, Configuration config, void*) {
+                    return concurrent_push_pop::fill(queue, config, threads);
+                },
+                [threads](PQ &queue, Configuration config, void* data) {
+                    concurrent_push_pop::run(queue, config, data, threads);
+                },
+                [threads](PQ&, Configuration config, void* data) {
+                    concurrent_push_pop::report_rank_error(config, data, threads);
+                }, configs, benchmarks);
+        }
+    }
+
+protected:
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+template <typename PQ>
+constexpr size_t concurrent_push_pop<PQ>::ops_per_element;
+
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "../common/aligned_allocator.h"
+#include "../common/contenders.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+namespace detail {
+
+/// Select the child that should move up: the first one that no other child
+/// of the same node is ordered after by comp. children points to count
+/// siblings. Specializations may use SIMD instructions if Vectorize is set.
+template <typename T, size_t D, typename Compare, bool Vectorize>
+struct select_child {
+    static constexpr bool vectorized = false;
+
+    static size_t select(const T *children, const size_t count, const Compare &comp) {
+        size_t best = 0;
+        for (size_t i = 1; i < count; ++i) {
+            if (comp(children[best], children[i])) best = i;
+        }
+        return best;
+    }
+};
+
+#ifdef __AVX2__
+// With AVX2, a full group of 8 or 16 int children is reduced to its maximum
+// with a few vector max and shuffle instructions, and a compare plus
+// movemask finds the first child that holds it. This replaces a chain of
+// data-dependent, poorly predictable branches. Partial groups at the end of
+// the heap use the scalar loop.
+
+// Broadcast the maximum of all eight lanes to every lane
+inline __m256i max_all_lanes(__m256i v) {
+    v = _mm256_max_epi32(v, _mm256_permute2x128_si256(v, v, 1));
+    v = _mm256_max_epi32(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm256_max_epi32(v, _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+inline unsigned lanes_equal(const __m256i a, const __m256i b) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+}
+
+template <>
+struct select_child<int32_t, 8, std::less<int32_t>, true> {
+    static constexpr bool vectorized = true;
+
+    static size_t select(const int32_t *children, const size_t count, const std::less<int32_t> &comp) {
+        if (count < 8) {
+            return select_child<int32_t, 8, std::less<int32_t>, false>::select(children, count, comp);
+        }
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(children));
+        return __builtin_ctz(lanes_equal(v, max_all_lanes(v)));
+    }
+};
+
+template <>
+struct select_child<int32_t, 16, std::less<int32_t>, true> {
+    static constexpr bool vectorized = true;
+
+    static size_t select(const int32_t *children, const size_t count, const std::less<int32_t> &comp) {
+        if (count < 16) {
+            return select_child<int32_t, 16, std::less<int32_t>, false>::select(children, count, comp);
+        }
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(children));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(children + 8));
+        const __m256i max = max_all_lanes(_mm256_max_epi32(lo, hi));
+        return __builtin_ctz(lanes_equal(lo, max) | (lanes_equal(hi, max) << 8));
+    }
+};
+#endif
+
+}
+
+/// Implicit D-ary max-heap (with the default std::less, like
+/// std::priority_queue). The array starts with D - 1 unused slots and is
+/// aligned to cache lines, so the children of every node start at a
+/// multiple of D. If D elements fill a cache line, all children of a node
+/// are in the same cache line, and sift-down touches one line per level.
+/// Vectorize selects SIMD child selection where detail::select_child has it.
+template <typename T,
+          size_t D = 4,
+          typename Compare = std::less<T>,
+          bool Vectorize = true>
+class dary_heap : public priority_queue<T> {
+    static_assert(D >= 2, "A heap node needs at least two children");
+    using selector = detail::select_child<T, D, Compare, Vectorize>;
+public:
+    dary_heap() : data(D - 1) {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("binary heap", "2-ary-heap",
+            [](){ return new dary_heap<T, 2>(); }
+        ));
+        list.register_contender(Factory("4-ary heap", "4-ary-heap",
+            [](){ return new dary_heap<T, 4>(); }
+        ));
+        list.register_contender(Factory("8-ary heap", "8-ary-heap",
+            [](){ return new dary_heap<T, 8>(); }
+        ));
+        list.register_contender(Factory("16-ary heap", "16-ary-heap",
+            [](){ return new dary_heap<T, 16>(); }
+        ));
+        // Compare against scalar child selection where there is a SIMD one
+        if (detail::select_child<T, 8, std::less<T>, true>::vectorized) {
+            list.register_contender(Factory("8-ary heap, scalar", "8-ary-heap-scalar",
+                [](){ return new dary_heap<T, 8, std::less<T>, false>(); }
+            ));
+        }
+        if (detail::select_child<T, 16, std::less<T>, true>::vectorized) {
+            list.register_contender(Factory("16-ary heap, scalar", "16-ary-heap-scalar",
+                [](){ return new dary_heap<T, 16, std::less<T>, false>(); }
+            ));
+        }
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        data.push_back(value);
+        sift_up(size() - 1);
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        data.push_back(std::move(value));
+        sift_up(size() - 1);
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        T value = std::move(data.back());
+        data.pop_back();
+        if (size() > 0) {
+            sift_down(0, std::move(value));
+        }
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        return data[D - 1];
+    }
+
+    /// Add the elements in [first, last). If that at least doubles the size,
+    /// the heap is rebuilt bottom-up with Floyd's algorithm in linear time.
+    void push_bulk(const T *first, const T *last) override {
+        const size_t old_size = size();
+        data.insert(data.end(), first, last);
+        if (size() - old_size < old_size) {
+            for (size_t k = old_size; k < size(); ++k) {
+                sift_up(k);
+            }
+            return;
+        }
+        // Sift down all inner nodes, starting with the last one
+        const size_t inner = size() > 1 ? (size() - 2) / D + 1 : 0;
+        for (size_t k = inner; k > 0; --k) {
+            T value = std::move(at(k - 1));
+            sift_down(k - 1, std::move(value));
+        }
+    }
+
+    /// Remove the n top elements and write them to out in descending order
+    void pop_n(size_t n, T *out) override {
+        assert(n <= size());
+        for (; n > 0; --n) {
+            *out++ = std::move(at(0));
+            T value = std::move(data.back());
+            data.pop_back();
+            if (size() > 0) {
+                sift_down(0, std::move(value));
+            }
+        }
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return data.size() - (D - 1);
+    }
+
+    /// Allocate space for n elements, so that pushes up to n don't reallocate
+    void reserve(const size_t n) {
+        data.reserve(n + (D - 1));
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new dary_heap();
+    }
+
+protected:
+    // Element k of the heap is stored at data[k + D - 1]
+    T& at(const size_t k) { return data[k + D - 1]; }
+
+    // Move the element at k up until its parent is not ordered before it
+    void sift_up(size_t k) {
+        T value = std::move(at(k));
+        while (k > 0) {
+            const size_t parent = (k - 1) / D;
+            if (!comp(at(parent), value)) break;
+            at(k) = std::move(at(parent));
+            k = parent;
+        }
+        at(k) = std::move(value);
+    }
+
+    // Move the hole at k down along the largest children until value fits
+    // into it
+    void sift_down(size_t k, T &&value) {
+        const size_t n = size();
+        while (true) {
+            const size_t first = D * k + 1;
+            if (first >= n) break;
+            const size_t count = std::min(D, n - first);
+            const size_t best = first + selector::select(&at(first), count, comp);
+            if (!comp(value, at(best))) break;
+            at(k) = std::move(at(best));
+            k = best;
+        }
+        at(k) = std::move(value);
+    }
+
+    Compare comp;
+    std::vector<T, common::aligned_allocator<T>> data;
+};
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+#include "addressable_priority_queue.h"
+
+namespace pq {
+
+template <typename PQ>
+class decrease_key {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+    using Addressable = addressable_priority_queue<T>;
+    using handle = typename Addressable::handle;
+
+    // Number of decrease-key operations per element in the queue
+    static constexpr size_t updates_per_element = 4;
+
+    struct state {
+        std::vector<T> values;
+        std::vector<handle> handles; // empty if the queue is not addressable
+        // element index and the amount to move it by
+        std::vector<std::pair<size_t, T>> updates;
+    };
+
+    /// Fill the queue with random elements below 2^30 and generate random
+    /// updates that move them up by at most 2^10, so that they do not
+    /// overflow
+    static void* fill(PQ &queue, Configuration config, void*) {
+        std::mt19937 random{config.second};
+        const size_t size = config.first;
+        Addressable *addressable = dynamic_cast<Addressable*>(&queue);
+        state *s = new state;
+        s->values.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            const T value = static_cast<T>(random() % (1u << 30));
+            s->values.push_back(value);
+            if (addressable != nullptr) {
+                s->handles.push_back(addressable->insert(value));
+            } else {
+                queue.push(value);
+            }
+        }
+        s->updates.reserve(updates_per_element * size);
+        for (size_t i = 0; i < updates_per_element * size; ++i) {
+            const size_t index = random() % size;
+            s->updates.emplace_back(index, static_cast<T>(1 + random() % (1u << 10)));
+        }
+        return s;
+    }
+
+    static void clear(PQ&, Configuration, void* data) {
+        delete static_cast<state*>(data);
+    }
+
+    /// Apply all updates, then pop all elements. Addressable queues move the
+    /// elements with decrease_key. The others push the new value and leave
+    /// the old one in the queue, which is how Dijkstra's algorithm is run
+    /// with queues without handles, so they pop more elements.
+    static void run(PQ &queue, Configuration, void* data) {
+        state *s = static_cast<state*>(data);
+        Addressable *addressable = dynamic_cast<Addressable*>(&queue);
+        for (const auto &update : s->updates) {
+            T &value = s->values[update.first];
+            value = static_cast<T>(value + update.second);
+            if (addressable != nullptr) {
+                addressable->decrease_key(s->handles[update.first], value);
+            } else {
+                queue.push(value);
+            }
+        }
+        while (queue.size() > 0) {
+            queue.pop();
+        }
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<16, 0xDECAF),
+            std::make_pair(1<<18, 0xBEEF),
+            std::make_pair(1<<20, 0xC0FFEE),
+            // beyond the L3 cache
+            std::make_pair(1<<22, 0xF005BA11)
+        };
+
+        common::register_benchmark("decrease-key", "decrease-key",
+            decrease_key::fill, decrease_key::run, decrease_key::clear,
+            configs, benchmarks);
+    }
+};
+
+template <typename PQ>
+constexpr size_t decrease_key<PQ>::updates_per_element;
+
+}
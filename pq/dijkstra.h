@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+#include "addressable_priority_queue.h"
+
+namespace pq {
+
+/// Dijkstra's algorithm from vertex 0 on synthetic graphs with config.first
+/// vertices, generated from the configuration's seed: a grid, a random
+/// geometric graph and an R-MAT graph with a power-law degree distribution.
+/// Addressable queues get an element per vertex and decrease_key, the others
+/// get a new element for every improved distance and skip outdated elements
+/// when they pop them (lazy deletion).
+///
+/// An element stores a distance and a vertex, with the vertex in the lowest
+/// bits. The distance is subtracted from the largest one that fits, so that
+/// the max-heaps pop the smallest distance first. With 32-bit elements this
+/// limits the graphs to 2^16 vertices and distances to 2^15.
+template <typename PQ>
+class dijkstra {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+    using Addressable = addressable_priority_queue<T>;
+    using handle = typename Addressable::handle;
+
+    // Edge weights are from [1, max_weight]
+    static constexpr uint32_t max_weight = 16;
+    static constexpr uint64_t unreachable = std::numeric_limits<uint64_t>::max();
+
+    /// Graph in compressed sparse row format
+    struct graph {
+        std::vector<uint32_t> offsets; // edges of v are [offsets[v], offsets[v + 1])
+        std::vector<uint32_t> targets, weights;
+
+        size_t size() const {
+            return offsets.size() - 1;
+        }
+
+        // Build from a list of (source, target, weight) triples
+        static graph from_edges(const size_t n, std::vector<std::pair<uint64_t, uint32_t>> &&edges) {
+            // Sorting by source and target keeps neighbours close in memory
+            std::sort(edges.begin(), edges.end());
+            graph g;
+            g.offsets.assign(n + 1, 0);
+            g.targets.reserve(edges.size());
+            g.weights.reserve(edges.size());
+            for (const auto &e : edges) {
+                ++g.offsets[(e.first >> 32) + 1];
+                g.targets.push_back(static_cast<uint32_t>(e.first));
+                g.weights.push_back(e.second);
+            }
+            for (size_t v = 0; v < n; ++v) {
+                g.offsets[v + 1] += g.offsets[v];
+            }
+            return g;
+        }
+    };
+
+    struct state {
+        graph g;
+        std::vector<uint64_t> reference; // distances from std::priority_queue
+        std::vector<uint64_t> distances;
+        std::vector<handle> handles;
+        int vertex_bits;
+    };
+
+    // An edge in both directions
+    static void add_undirected(std::vector<std::pair<uint64_t, uint32_t>> &edges,
+                               const uint64_t u, const uint64_t v, const uint32_t weight) {
+        edges.emplace_back(u << 32 | v, weight);
+        edges.emplace_back(v << 32 | u, weight);
+    }
+
+    /// Square grid with edges between horizontal and vertical neighbours
+    static graph grid(const size_t n, std::mt19937 &random) {
+        const size_t side = static_cast<size_t>(std::sqrt(static_cast<double>(n)));
+        assert(side * side == n);
+        std::vector<std::pair<uint64_t, uint32_t>> edges;
+        for (size_t y = 0; y < side; ++y) {
+            for (size_t x = 0; x < side; ++x) {
+                const size_t v = y * side + x;
+                if (x + 1 < side) add_undirected(edges, v, v + 1, 1 + random() % max_weight);
+                if (y + 1 < side) add_undirected(edges, v, v + side, 1 + random() % max_weight);
+            }
+        }
+        return graph::from_edges(n, std::move(edges));
+    }
+
+    /// Random points in the unit square with an edge between every two that
+    /// are closer than r, where r gives an expected degree of 8. Weights are
+    /// proportional to the distances.
+    static graph random_geometric(const size_t n, std::mt19937 &random) {
+        const double r = std::sqrt(8.0 / (std::acos(-1.0) * n));
+        std::uniform_real_distribution<double> coordinate(0, 1);
+        std::vector<std::pair<double, double>> points(n);
+        for (auto &p : points) {
+            p.first = coordinate(random);
+            p.second = coordinate(random);
+        }
+        // Find close points through a grid of cells of size r
+        const size_t cells = std::max<size_t>(static_cast<size_t>(1 / r), 1);
+        auto cell = [cells](const double c) { return std::min(static_cast<size_t>(c * cells), cells - 1); };
+        std::vector<std::vector<uint32_t>> buckets(cells * cells);
+        for (size_t v = 0; v < n; ++v) {
+            buckets[cell(points[v].second) * cells + cell(points[v].first)].push_back(v);
+        }
+        std::vector<std::pair<uint64_t, uint32_t>> edges;
+        for (size_t v = 0; v < n; ++v) {
+            const size_t cx = cell(points[v].first), cy = cell(points[v].second);
+            for (size_t y = cy > 0 ? cy - 1 : 0; y <= std::min(cy + 1, cells - 1); ++y) {
+                for (size_t x = cx > 0 ? cx - 1 : 0; x <= std::min(cx + 1, cells - 1); ++x) {
+                    for (const uint32_t u : buckets[y * cells + x]) {
+                        const double dx = points[u].first - points[v].first;
+                        const double dy = points[u].second - points[v].second;
+                        const double d = std::sqrt(dx * dx + dy * dy);
+                        if (u != v && d < r) {
+                            const uint32_t weight = 1 + static_cast<uint32_t>(d / r * (max_weight - 1));
+                            edges.emplace_back(static_cast<uint64_t>(v) << 32 | u, weight);
+                        }
+                    }
+                }
+            }
+        }
+        return graph::from_edges(n, std::move(edges));
+    }
+
+    /// Directed R-MAT graph (Chakrabarti et al. 2004) with 8 edges per
+    /// vertex. Every edge picks a quadrant of the adjacency matrix with
+    /// probabilities 0.57, 0.19, 0.19 and 0.05 on every level, so low vertex
+    /// numbers, including the source 0, are hubs.
+    static graph rmat(const size_t n, std::mt19937 &random) {
+        const int scale = __builtin_ctzll(n);
+        assert((size_t(1) << scale) == n);
+        std::vector<std::pair<uint64_t, uint32_t>> edges;
+        for (size_t i = 0; i < 8 * n; ++i) {
+            uint64_t u = 0, v = 0;
+            for (int level = 0; level < scale; ++level) {
+                const uint32_t p = random() % 100;
+                u = u << 1 | (p >= 76);
+                v = v << 1 | ((p >= 57 && p < 76) || p >= 95);
+            }
+            edges.emplace_back(u << 32 | v, 1 + random() % max_weight);
+        }
+        return graph::from_edges(n, std::move(edges));
+    }
+
+    /// Distances from vertex 0 with std::priority_queue and lazy deletion
+    static std::vector<uint64_t> reference_distances(const graph &g) {
+        std::vector<uint64_t> distances(g.size(), unreachable);
+        using entry = std::pair<uint64_t, uint32_t>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+        distances[0] = 0;
+        queue.emplace(0, 0);
+        while (!queue.empty()) {
+            const entry e = queue.top();
+            queue.pop();
+            if (e.first > distances[e.second]) continue;
+            for (uint32_t i = g.offsets[e.second]; i < g.offsets[e.second + 1]; ++i) {
+                const uint64_t d = e.first + g.weights[i];
+                if (d < distances[g.targets[i]]) {
+                    distances[g.targets[i]] = d;
+                    queue.emplace(d, g.targets[i]);
+                }
+            }
+        }
+        return distances;
+    }
+
+    template <graph (*Generate)(size_t, std::mt19937&)>
+    static void* fill(PQ&, Configuration config, void*) {
+        std::mt19937 random{config.second};
+        state *s = new state;
+        s->g = Generate(config.first, random);
+        s->reference = reference_distances(s->g);
+        s->vertex_bits = 64 - __builtin_clzll(std::max<size_t>(config.first - 1, 1));
+        uint64_t max_distance = 0;
+        for (const uint64_t d : s->reference) {
+            if (d != unreachable) max_distance = std::max(max_distance, d);
+        }
+        if (max_distance > max_encodable(s->vertex_bits)) {
+            throw std::length_error("dijkstra: distances don't fit into the elements");
+        }
+        s->distances.resize(config.first);
+        s->handles.resize(config.first);
+        return s;
+    }
+
+    static void check_distances(PQ&, Configuration, void* data) {
+        state *s = static_cast<state*>(data);
+        assert(s->distances == s->reference);
+        delete s;
+    }
+
+    static void run(PQ &queue, Configuration, void* data) {
+        state &s = *static_cast<state*>(data);
+        const graph &g = s.g;
+        const int bits = s.vertex_bits;
+        const uint64_t top_distance = max_encodable(bits), mask = (uint64_t(1) << bits) - 1;
+        auto encode = [bits, top_distance](const uint64_t distance, const uint32_t v) {
+            return static_cast<T>((top_distance - distance) << bits | v);
+        };
+        std::fill(s.distances.begin(), s.distances.end(), unreachable);
+        Addressable *addressable = dynamic_cast<Addressable*>(&queue);
+
+        s.distances[0] = 0;
+        if (addressable != nullptr) {
+            std::fill(s.handles.begin(), s.handles.end(), nullptr);
+            s.handles[0] = addressable->insert(encode(0, 0));
+        } else {
+            queue.push(encode(0, 0));
+        }
+        while (queue.size() > 0) {
+            const uint64_t key = static_cast<uint64_t>(queue.top());
+            queue.pop();
+            const uint32_t u = static_cast<uint32_t>(key & mask);
+            const uint64_t distance = top_distance - (key >> bits);
+            if (addressable != nullptr) {
+                s.handles[u] = nullptr;
+            } else if (distance > s.distances[u]) {
+                continue; // outdated
+            }
+            for (uint32_t i = g.offsets[u]; i < g.offsets[u + 1]; ++i) {
+                const uint32_t v = g.targets[i];
+                const uint64_t d = distance + g.weights[i];
+                if (d >= s.distances[v]) continue;
+                const bool queued = s.distances[v] != unreachable;
+                s.distances[v] = d;
+                if (addressable == nullptr) {
+                    queue.push(encode(d, v));
+                } else if (queued) {
+                    addressable->decrease_key(s.handles[v], encode(d, v));
+                } else {
+                    s.handles[v] = addressable->insert(encode(d, v));
+                }
+            }
+        }
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<12, 0xDECAF),
+            std::make_pair(1<<14, 0xBEEF),
+            std::make_pair(1<<16, 0xC0FFEE)
+        };
+
+        common::register_benchmark("Dijkstra on a grid", "dijkstra-grid",
+            dijkstra::fill<dijkstra::grid>, dijkstra::run, dijkstra::check_distances,
+            configs, benchmarks);
+        common::register_benchmark("Dijkstra on a random geometric graph", "dijkstra-geometric",
+            dijkstra::fill<dijkstra::random_geometric>, dijkstra::run, dijkstra::check_distances,
+            configs, benchmarks);
+        common::register_benchmark("Dijkstra on an R-MAT graph", "dijkstra-rmat",
+            dijkstra::fill<dijkstra::rmat>, dijkstra::run, dijkstra::check_distances,
+            configs, benchmarks);
+    }
+
+protected:
+    // Largest distance that fits into an element next to the vertex
+    static uint64_t max_encodable(const int vertex_bits) {
+        return (uint64_t(1) << (std::numeric_limits<T>::digits - vertex_bits)) - 1;
+    }
+};
+
+template <typename PQ>
+constexpr uint32_t dijkstra<PQ>::max_weight;
+template <typename PQ>
+constexpr uint64_t dijkstra<PQ>::unreachable;
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Priority queue that also gives access to the element at the other end,
+/// the one that would be popped last. The queues are max-heaps, so with the
+/// default comparison this is the smallest element. Benchmarks find out
+/// whether a contender supports it with a dynamic_cast, like for addressable
+/// queues.
+template <typename T>
+class double_ended_priority_queue : public priority_queue<T> {
+public:
+    // You also need to provide the following:
+    // static void register_contenders(common::contender_list<priority_queue<T>> &list)
+
+    /// Deletes the bottom element
+    virtual void pop_min() = 0;
+
+    /// Retrieves the bottom element, which would be popped last
+    virtual const T& top_min() = 0;
+};
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+#include "string_key.h"
+
+namespace pq {
+
+/// Benchmarks on string elements with a long common prefix, like the names
+/// of rules in a rule engine, where the number of comparisons and not the
+/// memory accesses limits the performance. PQ::value_type must be
+/// constructible from a std::string and count its comparisons like
+/// string_key. Every run prints the number of comparisons per element.
+template <typename PQ>
+class expensive_compare {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+
+    /// size random keys that only differ after a 22-byte prefix, so that
+    /// every comparison reads past it and the strings are on the heap
+    static std::vector<T>* random_keys(const size_t size, const size_t seed) {
+        std::mt19937 random{seed};
+        std::vector<T> *keys = new std::vector<T>;
+        keys->reserve(size);
+        char digits[16];
+        for (size_t i = 0; i < size; ++i) {
+            std::snprintf(digits, sizeof(digits), "%010u", static_cast<unsigned>(random()));
+            keys->emplace_back(std::string("rules/agenda/salience/") + digits);
+        }
+        return keys;
+    }
+
+    static void* fill_data(PQ&, Configuration config, void*) {
+        std::vector<T> *keys = random_keys(config.first, config.second);
+        T::reset_comparisons();
+        return keys;
+    }
+
+    static void* fill_both(PQ &queue, Configuration config, void*) {
+        std::vector<T> *keys = random_keys(config.first, config.second);
+        for (const T &key : *keys) {
+            queue.push(key);
+        }
+        delete keys;
+        keys = random_keys(config.first, config.second + 1);
+        T::reset_comparisons();
+        return keys;
+    }
+
+    static void report_comparisons(PQ&, Configuration config, void* data) {
+        delete static_cast<std::vector<T>*>(data);
+        const size_t comparisons = T::comparisons();
+        std::cout << "\t" << comparisons << " comparisons on " << config.first
+                  << " elements, " << static_cast<double>(comparisons) / config.first
+                  << " per element" << std::endl;
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<12, 0x5EED),
+            std::make_pair(1<<16, 0xBEEF),
+            std::make_pair(1<<20, 0xC0FFEE)};
+
+        common::register_benchmark("heapsort strings", "heapsort-string",
+            expensive_compare::fill_data,
+            [](PQ &queue, Configuration, void* data) {
+                std::vector<T> &keys = *static_cast<std::vector<T>*>(data);
+                for (T &key : keys) {
+                    queue.push(std::move(key));
+                }
+                for (T &key : keys) {
+                    key = queue.top();
+                    queue.pop();
+                }
+            }, expensive_compare::report_comparisons, configs, benchmarks);
+
+        common::register_benchmark("push-pop mix on strings", "push-pop-mix-string",
+            expensive_compare::fill_both,
+            [](PQ &queue, Configuration, void* data) {
+                std::vector<T> &keys = *static_cast<std::vector<T>*>(data);
+                for (T &key : keys) {
+                    queue.push(std::move(key));
+                    queue.pop();
+                }
+            }, expensive_compare::report_comparisons, configs, benchmarks);
+    }
+};
+
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../common/contenders.h"
+#include "../common/io_stats.h"
+#include "dary_heap.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// External-memory max-heap for queues that are larger than the memory
+/// budget. New elements go to an in-memory d-ary heap that takes half of the
+/// budget. When it is full, it is written to a temporary file as a run
+/// sorted in pop order. The other half of the budget holds two blocks per
+/// run, the one that is being popped from and the next one, which is read
+/// asynchronously while the first is consumed. The runs' front elements
+/// are merged with a heap. When there are too many runs for the budget, the
+/// half with the fewest remaining elements is merged into a single run.
+///
+/// Temporary files go to $TMPDIR (or /tmp) and are unlinked right away.
+/// Elements are written as bytes, so T must be trivially copyable.
+template <typename T,
+          typename Compare = std::less<T>>
+class external_pq : public priority_queue<T> {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "external_pq writes elements to files byte by byte");
+public:
+    external_pq(const size_t memory_budget, const size_t block_size = 1 << 18)
+        : memory_budget(memory_budget),
+          block_size(block_size),
+          block_elements(std::max<size_t>(block_size / sizeof(T), 1)),
+          capacity(std::max<size_t>(memory_budget / 2 / sizeof(T), 1)),
+          max_runs(std::max<size_t>((memory_budget / 2 - std::min(memory_budget / 2, block_size)) / (2 * block_size), 2)),
+          num(0)
+    {
+        heap.reserve(capacity);
+    }
+    external_pq(const external_pq&) = delete;
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list,
+                                    const size_t memory_budget = 16 << 20) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory(
+            "external PQ, " + std::to_string(memory_budget >> 20) + " MiB",
+            "external-pq-" + std::to_string(memory_budget >> 20),
+            [memory_budget](){ return new external_pq<T>(memory_budget); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        if (heap.size() == capacity) spill();
+        heap.push(value);
+        ++num;
+    }
+    /// Add an element by rvalue reference, which is the same for trivially
+    /// copyable elements
+    void push(T&& value) override {
+        push(static_cast<const T&>(value));
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        if (top_in_heap()) {
+            heap.pop();
+        } else {
+            std::pop_heap(merger.begin(), merger.end(), run_less());
+            run *r = merger.back();
+            if (r->advance()) {
+                std::push_heap(merger.begin(), merger.end(), run_less());
+            } else {
+                merger.pop_back();
+                remove_run(r);
+            }
+        }
+        --num;
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return top_in_heap() ? heap.top() : merger.front()->front();
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new external_pq(memory_budget, block_size);
+    }
+
+protected:
+    // A sorted run in a temporary file, read block by block
+    class run {
+    public:
+        run(const int fd, const size_t length, const size_t block_elements)
+            : fd(fd), length(length), remaining(length), loaded(0), pos(0),
+              block_elements(block_elements)
+        {
+            assert(length > 0);
+            prefetch();
+            load_next();
+        }
+        run(const run&) = delete;
+
+        ~run() {
+            if (pending.valid()) pending.wait();
+            close(fd);
+        }
+
+        const T& front() const {
+            return current[pos];
+        }
+
+        size_t size() const {
+            return remaining;
+        }
+
+        // Move to the next element, returns false if the run is exhausted
+        bool advance() {
+            --remaining;
+            if (++pos < current.size()) return true;
+            if (remaining == 0) return false;
+            load_next();
+            return true;
+        }
+
+    protected:
+        // Wait for the prefetched block, make it current and prefetch the next
+        void load_next() {
+            pending.get();
+            current.swap(next);
+            pos = 0;
+            prefetch();
+        }
+
+        void prefetch() {
+            const size_t offset = loaded;
+            const size_t count = std::min(block_elements, length - loaded);
+            if (count == 0) return;
+            next.resize(count);
+            loaded += count;
+            common::io_stats::add_read(count * sizeof(T));
+            T *target = next.data();
+            const int file = fd;
+            pending = std::async(std::launch::async, [file, target, count, offset]() {
+                read_fully(file, target, count, offset);
+            });
+        }
+
+        int fd;
+        size_t length, remaining, loaded, pos, block_elements;
+        std::vector<T> current, next;
+        std::future<void> pending;
+    };
+
+    // Orders runs by their front elements for a max-heap of runs
+    struct run_less {
+        bool operator()(const run *a, const run *b) const {
+            return Compare()(a->front(), b->front());
+        }
+    };
+
+    bool top_in_heap() {
+        if (merger.empty()) return true;
+        return heap.size() > 0 && !comp(heap.top(), merger.front()->front());
+    }
+
+    // Write the in-memory heap to a new run
+    void spill() {
+        // Queues that never spill, like the many small ones of the meld
+        // benchmarks, don't need the write buffer
+        if (buffer.empty()) buffer.resize(block_elements);
+        if (runs.size() >= max_runs) merge_smallest_runs();
+        const int fd = create_file();
+        const size_t length = heap.size();
+        for (size_t offset = 0; offset < length; ) {
+            const size_t count = std::min(block_elements, heap.size());
+            heap.pop_n(count, buffer.data());
+            write_fully(fd, buffer.data(), count, offset);
+            offset += count;
+        }
+        add_run(new run(fd, length, block_elements));
+    }
+
+    // Merge the half of the runs with the fewest remaining elements into one
+    void merge_smallest_runs() {
+        std::vector<run*> sources;
+        for (auto &r : runs) sources.push_back(r.get());
+        std::sort(sources.begin(), sources.end(), [](const run *a, const run *b) {
+            return a->size() < b->size();
+        });
+        sources.resize(std::max<size_t>(sources.size() / 2, 2));
+
+        size_t length = 0;
+        for (run *r : sources) length += r->size();
+        const int fd = create_file();
+        std::make_heap(sources.begin(), sources.end(), run_less());
+        size_t offset = 0, used = 0;
+        while (!sources.empty()) {
+            std::pop_heap(sources.begin(), sources.end(), run_less());
+            run *r = sources.back();
+            buffer[used++] = r->front();
+            if (used == block_elements) {
+                write_fully(fd, buffer.data(), used, offset);
+                offset += used;
+                used = 0;
+            }
+            if (r->advance()) {
+                std::push_heap(sources.begin(), sources.end(), run_less());
+            } else {
+                sources.pop_back();
+                merger.erase(std::find(merger.begin(), merger.end(), r));
+                remove_run(r);
+            }
+        }
+        write_fully(fd, buffer.data(), used, offset);
+        // The sources are gone, fix the order of the remaining runs
+        std::make_heap(merger.begin(), merger.end(), run_less());
+        add_run(new run(fd, length, block_elements));
+    }
+
+    void add_run(run *r) {
+        runs.emplace_back(r);
+        merger.push_back(r);
+        std::push_heap(merger.begin(), merger.end(), run_less());
+    }
+
+    void remove_run(run *r) {
+        runs.erase(std::find_if(runs.begin(), runs.end(),
+            [r](const std::unique_ptr<run> &p) { return p.get() == r; }));
+    }
+
+    // Create a temporary file that is deleted when it is closed
+    static int create_file() {
+        const char *dir = std::getenv("TMPDIR");
+        std::string path = std::string(dir != nullptr ? dir : "/tmp") + "/external_pq_XXXXXX";
+        const int fd = mkstemp(&path[0]);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "mkstemp");
+        unlink(path.c_str());
+        return fd;
+    }
+
+    static void write_fully(const int fd, const T *data, const size_t count, const size_t offset) {
+        const char *bytes = reinterpret_cast<const char*>(data);
+        size_t done = 0, total = count * sizeof(T);
+        while (done < total) {
+            const ssize_t ret = pwrite(fd, bytes + done, total - done, offset * sizeof(T) + done);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "pwrite");
+            }
+            done += ret;
+        }
+        common::io_stats::add_written(total);
+    }
+
+    static void read_fully(const int fd, T *data, const size_t count, const size_t offset) {
+        char *bytes = reinterpret_cast<char*>(data);
+        size_t done = 0, total = count * sizeof(T);
+        while (done < total) {
+            const ssize_t ret = pread(fd, bytes + done, total - done, offset * sizeof(T) + done);
+            if (ret <= 0) {
+                if (ret < 0 && errno == EINTR) continue;
+                throw std::system_error(ret < 0 ? errno : EIO, std::generic_category(), "pread");
+            }
+            done += ret;
+        }
+    }
+
+    Compare comp;
+    const size_t memory_budget, block_size, block_elements;
+    const size_t capacity; // elements in the in-memory heap
+    const size_t max_runs;
+    dary_heap<T, 4, Compare> heap;
+    std::vector<std::unique_ptr<run>> runs;
+    std::vector<run*> merger; // heap of the runs by their front elements
+    std::vector<T> buffer;    // write buffer for spilling and merging, see spill()
+    size_t num;
+};
+
+}
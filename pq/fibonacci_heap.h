@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "../common/node_pool.h"
+#include "addressable_priority_queue.h"
+
+namespace pq {
+
+/// Fibonacci heap (Fredman, Tarjan 1987) as a max-heap. The roots and the
+/// children of every node form circular doubly linked lists. insert and
+/// decrease_key only add trees to the root list, pop then links roots of
+/// equal degree until all degrees differ. A node that loses a second child
+/// is cut from its parent as well, which bounds the degrees by
+/// log_phi(n). Nodes come from a pool, and the destructor is iterative.
+template <typename T,
+          typename Compare = std::less<T>>
+class fibonacci_heap : public addressable_priority_queue<T> {
+public:
+    using handle = typename addressable_priority_queue<T>::handle;
+
+    fibonacci_heap() : max(nullptr), num(0) {}
+    fibonacci_heap(const fibonacci_heap&) = delete;
+
+    virtual ~fibonacci_heap() {
+        destroy_all();
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("Fibonacci heap", "fibonacci-heap",
+            [](){ return new fibonacci_heap<T>(); }
+        ));
+    }
+
+    /// Add an element by const lvalue reference and return a handle to it
+    handle insert(const T& value) override {
+        return add(pool.create(value));
+    }
+    /// Add an element by rvalue reference (with move) and return a handle to it
+    handle insert(T&& value) override {
+        return add(pool.create(std::move(value)));
+    }
+
+    /// Move an element towards the top by replacing it with value
+    void decrease_key(handle h, const T& value) override {
+        node *n = static_cast<node*>(h);
+        assert(!comp(value, n->value));
+        n->value = value;
+        node *parent = n->parent;
+        if (parent != nullptr && comp(parent->value, n->value)) {
+            cut(n);
+            cascading_cut(parent);
+        }
+        if (comp(max->value, n->value)) max = n;
+    }
+
+    /// Remove an element
+    void erase(handle h) override {
+        node *n = static_cast<node*>(h);
+        if (n->parent != nullptr) {
+            node *parent = n->parent;
+            cut(n);
+            cascading_cut(parent);
+        }
+        remove_root(n);
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        remove_root(max);
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return max->value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new fibonacci_heap();
+    }
+
+    /// Move all elements of other into this heap, in constant time if it is
+    /// a Fibonacci heap of the same type. Handles into other stay valid.
+    void meld(priority_queue<T> &&other) override {
+        auto *o = dynamic_cast<fibonacci_heap*>(&other);
+        if (o == nullptr || o == this) {
+            priority_queue<T>::meld(std::move(other));
+            return;
+        }
+        if (o->max != nullptr) {
+            if (max == nullptr) {
+                max = o->max;
+            } else {
+                // Concatenate the root lists
+                node *right = max->right, *left = o->max->left;
+                max->right = o->max;
+                o->max->left = max;
+                left->right = right;
+                right->left = left;
+                if (comp(max->value, o->max->value)) max = o->max;
+            }
+        }
+        num += o->num;
+        pool.absorb(o->pool);
+        o->max = nullptr;
+        o->num = 0;
+    }
+
+protected:
+    // Degrees are below log_phi(2^64) < 93
+    static constexpr size_t max_degree = 96;
+
+    struct node {
+        template <typename V>
+        explicit node(V &&value)
+            : value(std::forward<V>(value)), parent(nullptr), child(nullptr),
+              left(this), right(this), degree(0), marked(false) {}
+
+        T value;
+        node *parent, *child;
+        node *left, *right; // siblings
+        unsigned degree;
+        bool marked; // lost a child since it became a child itself
+    };
+
+    handle add(node *n) {
+        add_root(n);
+        ++num;
+        return n;
+    }
+
+    // Insert a single node into the root list and update max
+    void add_root(node *n) {
+        n->parent = nullptr;
+        n->marked = false;
+        if (max == nullptr) {
+            n->left = n->right = n;
+            max = n;
+            return;
+        }
+        splice(max, n);
+        if (comp(max->value, n->value)) max = n;
+    }
+
+    // Insert a single node into a circular list after position
+    static void splice(node *position, node *n) {
+        n->left = position;
+        n->right = position->right;
+        position->right->left = n;
+        position->right = n;
+    }
+
+    // Remove a node from its circular list
+    static void unlink(node *n) {
+        n->left->right = n->right;
+        n->right->left = n->left;
+        n->left = n->right = n;
+    }
+
+    // Move a node with a parent to the root list
+    void cut(node *n) {
+        node *parent = n->parent;
+        if (n->right == n) {
+            parent->child = nullptr;
+        } else {
+            if (parent->child == n) parent->child = n->right;
+            unlink(n);
+        }
+        --parent->degree;
+        add_root(n);
+    }
+
+    // Cut marked ancestors, and mark the first unmarked one
+    void cascading_cut(node *n) {
+        while (n->parent != nullptr) {
+            if (!n->marked) {
+                n->marked = true;
+                return;
+            }
+            node *parent = n->parent;
+            cut(n);
+            n = parent;
+        }
+    }
+
+    // Remove and destroy a root, moving its children to the root list
+    void remove_root(node *n) {
+        assert(n->parent == nullptr);
+        node *child = n->child;
+        if (child != nullptr) {
+            do {
+                node *next = child->right;
+                child->parent = nullptr;
+                child->marked = false;
+                splice(n, child);
+                child = next;
+            } while (child != n->child);
+        }
+        node *rest = (n->right == n) ? nullptr : n->right;
+        const bool was_max = (n == max);
+        unlink(n);
+        pool.destroy(n);
+        --num;
+        if (was_max) {
+            max = rest;
+            if (rest != nullptr) consolidate();
+        }
+    }
+
+    // Link roots of equal degree until all roots have different degrees,
+    // and find the new maximum
+    void consolidate() {
+        roots.clear();
+        node *r = max;
+        do {
+            roots.push_back(r);
+            r = r->right;
+        } while (r != max);
+
+        std::fill(std::begin(by_degree), std::end(by_degree), nullptr);
+        for (node *x : roots) {
+            x->left = x->right = x;
+            unsigned degree = x->degree;
+            while (by_degree[degree] != nullptr) {
+                node *y = by_degree[degree];
+                by_degree[degree] = nullptr;
+                if (comp(x->value, y->value)) std::swap(x, y);
+                make_child(y, x);
+                ++degree;
+            }
+            by_degree[degree] = x;
+        }
+
+        max = nullptr;
+        for (node *x : by_degree) {
+            if (x != nullptr) add_root(x);
+        }
+    }
+
+    // Make root y a child of root x
+    void make_child(node *y, node *x) {
+        y->parent = x;
+        y->marked = false;
+        if (x->child == nullptr) {
+            y->left = y->right = y;
+            x->child = y;
+        } else {
+            splice(x->child, y);
+        }
+        ++x->degree;
+    }
+
+    // Destroy all elements without recursion. The pool frees the memory.
+    void destroy_all() {
+        if (std::is_trivially_destructible<T>::value || max == nullptr) return;
+        std::vector<node*> stack;
+        node *r = max;
+        do {
+            stack.push_back(r);
+            r = r->right;
+        } while (r != max);
+        while (!stack.empty()) {
+            node *n = stack.back();
+            stack.pop_back();
+            if (n->child != nullptr) {
+                node *c = n->child;
+                do {
+                    stack.push_back(c);
+                    c = c->right;
+                } while (c != n->child);
+            }
+            pool.destroy(n);
+        }
+    }
+
+    Compare comp;
+    common::node_pool<node> pool;
+    node *max;
+    size_t num;
+    std::vector<node*> roots;      // used by consolidate
+    node *by_degree[max_degree];   // used by consolidate
+};
+
+template <typename T, typename Compare>
+constexpr size_t fibonacci_heap<T, Compare>::max_degree;
+
+}
@@ -7,6 +7,9 @@
 #include <ext/pb_ds/priority_queue.hpp>
 #include <utility>
 
+#include "../common/contenders.h"
+#include "../common/node_pool.h"
+#include "addressable_priority_queue.h"
 #include "priority_queue.h"
 
 namespace pq {
@@ -78,10 +81,152 @@ public:
         return queue.size();
     }
 
+    priority_queue<T>* create_empty() const override {
+        return new gnu_pq();
+    }
+
+    /// Move all elements of other into this queue, with pb_ds join if it is
+    /// a gnu_pq of the same type
+    void meld(priority_queue<T> &&other) override {
+        auto *o = dynamic_cast<gnu_pq*>(&other);
+        if (o == nullptr || o == this) {
+            priority_queue<T>::meld(std::move(other));
+            return;
+        }
+        queue.join(o->queue);
+    }
+
 protected:
     __gnu_pbds::priority_queue<T, Cmp_Fn, Tag, Allocator> queue;
 };
 
+/// GNU heap with handles for decrease_key and erase. Every element carries
+/// a pointer to its handle, so this is a separate contender, and gnu_pq
+/// stays as fast as it was for the benchmarks that don't use handles.
+template<typename T,
+         typename Cmp_Fn = std::less<T>,
+         typename Tag = __gnu_pbds::pairing_heap_tag,
+         typename Allocator = std::allocator<char>>
+class gnu_addressable_pq : public addressable_priority_queue<T> {
+    struct entry;
+    struct entry_compare {
+        Cmp_Fn comp;
+        bool operator()(const entry &a, const entry &b) const {
+            return comp(a.value, b.value);
+        }
+    };
+    using queue_type = __gnu_pbds::priority_queue<entry, entry_compare, Tag, Allocator>;
+    using point_iterator = typename queue_type::point_iterator;
+
+    // Elements that were inserted with a handle point to it, so that pop
+    // can free the handle. A handle is the element's point_iterator, kept
+    // in a pool so that it has a fixed address.
+    struct entry {
+        T value;
+        point_iterator *slot;
+    };
+public:
+    using handle = typename addressable_priority_queue<T>::handle;
+
+    gnu_addressable_pq() : queue() {}
+
+    virtual ~gnu_addressable_pq() {
+        bool is_pairing_heap = std::is_same<Tag,  __gnu_pbds::pairing_heap_tag>::value;
+        if (is_pairing_heap) {
+            // Pairing heap has a recursive destructor
+            queue.clear();
+        }
+    };
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("GNU Pairing Heap, addressable", "GNU-pairing-heap-addressable",
+            [](){ return new gnu_addressable_pq<T, std::less<T>, __gnu_pbds::pairing_heap_tag>();}
+        ));
+        list.register_contender(Factory("GNU Thin Heap, addressable", "GNU-thin-heap-addressable",
+            [](){ return new gnu_addressable_pq<T, std::less<T>, __gnu_pbds::thin_heap_tag>();}
+        ));
+    }
+
+    /// Add an element by const lvalue reference and return a handle to it
+    handle insert(const T& value) override {
+        return insert_entry(entry{value, nullptr});
+    }
+    /// Add an element by rvalue reference (with move) and return a handle to it
+    handle insert(T&& value) override {
+        return insert_entry(entry{std::move(value), nullptr});
+    }
+
+    /// Add an element to the priority queue by const lvalue reference,
+    /// without a handle
+    void push(const T& value) override {
+        queue.push(entry{value, nullptr});
+    }
+    /// Add an element to the priority queue by rvalue reference (with move),
+    /// without a handle
+    void push(T&& value) override {
+        queue.push(entry{std::move(value), nullptr});
+    }
+
+    /// Move an element towards the top by replacing it with value
+    void decrease_key(handle h, const T& value) override {
+        point_iterator *slot = static_cast<point_iterator*>(h);
+        queue.modify(*slot, entry{value, slot});
+    }
+
+    /// Remove an element
+    void erase(handle h) override {
+        point_iterator *slot = static_cast<point_iterator*>(h);
+        queue.erase(*slot);
+        slots.destroy(slot);
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        point_iterator *slot = queue.top().slot;
+        if (slot != nullptr) slots.destroy(slot);
+        queue.pop();
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        return queue.top().value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return queue.size();
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new gnu_addressable_pq();
+    }
+
+    /// Move all elements of other into this queue, with pb_ds join if it is
+    /// a gnu_addressable_pq of the same type
+    void meld(priority_queue<T> &&other) override {
+        auto *o = dynamic_cast<gnu_addressable_pq*>(&other);
+        if (o == nullptr || o == this) {
+            priority_queue<T>::meld(std::move(other));
+            return;
+        }
+        queue.join(o->queue);
+        // The handles of o's elements stay valid
+        slots.absorb(o->slots);
+    }
+
+protected:
+    handle insert_entry(entry &&e) {
+        point_iterator *slot = slots.create();
+        e.slot = slot;
+        *slot = queue.push(std::move(e));
+        return slot;
+    }
+
+    queue_type queue;
+    common::node_pool<point_iterator> slots;
+};
+
 }
 
 #endif
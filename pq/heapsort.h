@@ -29,13 +29,33 @@ public:
         }
     }
 
+    /// Like sort, but with one push_bulk and one pop_n call
+    template<typename T>
+    static void sort_bulk(PQ &heap, T *begin, T *end) {
+        const size_t n = end - begin;
+        heap.push_bulk(begin, end);
+        heap.pop_n(n, begin);
+    }
+
+    static void check_permutation(PQ&, Configuration config, void* data) {
+        auto ptr = static_cast<typename PQ::value_type*>(data);
+        // Check that data is sorted
+        for (size_t i = 0; i < config.first; ++i) {
+            assert(ptr[i] == static_cast<typename PQ::value_type>(config.first - i - 1));
+        }
+        delete[] ptr;
+    }
+
 
     static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
         const std::vector<Configuration> configs{
             std::make_pair(1<<16, 1234567),
             std::make_pair(1<<18, 0xBEEF),
             std::make_pair(1<<20, 0xC0FFEE),
-            /*1<<22, 1<<24, 1<<26*/};
+            // beyond the L3 cache
+            std::make_pair(1<<22, 0xF005BA11),
+            std::make_pair(1<<24, 0xBA5EBA11),
+            std::make_pair(1<<26, 0xCA55E77E)};
 
         common::register_benchmark("heapsort permutation", "heapsort-perm",
             microbenchmark<PQ>::fill_data_permutation,
@@ -44,14 +64,16 @@ public:
                 auto ptr = static_cast<typename PQ::value_type*>(data);
                 heapsort::sort(queue, ptr, ptr+config.first);
             },
-            [](PQ&, Configuration config, void* data) {
+            heapsort::check_permutation, configs, benchmarks);
+
+        common::register_benchmark("heapsort permutation with bulk operations", "heapsort-bulk",
+            microbenchmark<PQ>::fill_data_permutation,
+            [](PQ &queue, Configuration config, void* data) {
+                assert(data != nullptr);
                 auto ptr = static_cast<typename PQ::value_type*>(data);
-                // Check that data is sorted
-                for (size_t i = 0; i < config.first; ++i) {
-                    assert(ptr[i] == static_cast<typename PQ::value_type>(config.first - i - 1));
-                }
-                delete[] ptr;
-            }, configs, benchmarks);
+                heapsort::sort_bulk(queue, ptr, ptr+config.first);
+            },
+            heapsort::check_permutation, configs, benchmarks);
 
         common::register_benchmark("heapsort random", "heapsort-rand",
             microbenchmark<PQ>::template fill_data_random<1>,
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+
+namespace pq {
+
+/// Merge K sorted runs of N/K elements each with the queue as the merger,
+/// the way external sorting and the merging of search results use priority
+/// queues. The queue holds the front element of every run and gets the next
+/// element of the top's run after every pop. Elements are key * K + run, so
+/// the run of the top can be computed from its value.
+template <typename PQ>
+class kway_merge {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+
+    struct state {
+        std::vector<T> runs;  // the runs one after another, each descending
+        std::vector<T> out;
+        std::vector<size_t> next; // index of the next element of every run
+    };
+
+    static void* fill(PQ&, Configuration config, const size_t k) {
+        std::mt19937 random{config.second};
+        const size_t n = config.first, length = n / k;
+        const size_t max_key = std::min<size_t>(std::numeric_limits<T>::max(), 1u << 31) / k;
+        state *s = new state;
+        s->runs.resize(n);
+        for (size_t r = 0; r < k; ++r) {
+            const auto first = s->runs.begin() + r * length;
+            for (size_t i = 0; i < length; ++i) {
+                first[i] = static_cast<T>((random() % max_key) * k + r);
+            }
+            std::sort(first, first + length, std::greater<T>());
+        }
+        s->out.resize(n);
+        s->next.resize(k);
+        return s;
+    }
+
+    static void run(PQ &queue, Configuration config, void* data, const size_t k) {
+        state &s = *static_cast<state*>(data);
+        const size_t n = config.first, length = n / k;
+        for (size_t r = 0; r < k; ++r) {
+            queue.push(s.runs[r * length]);
+            s.next[r] = 1;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const T value = queue.top();
+            queue.pop();
+            s.out[i] = value;
+            // k is a power of two
+            const size_t r = static_cast<size_t>(value) & (k - 1);
+            if (s.next[r] < length) {
+                queue.push(s.runs[r * length + s.next[r]++]);
+            }
+        }
+    }
+
+    static void check_sorted(PQ&, Configuration, void* data) {
+        state *s = static_cast<state*>(data);
+        assert(std::is_sorted(s->out.rbegin(), s->out.rend()));
+        delete s;
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<20, 0xC0FFEE),
+            // beyond the L3 cache
+            std::make_pair(1<<23, 0xF005BA11)};
+
+        for (const size_t k : {2, 16, 128, 1024, 4096}) {
+            common::register_benchmark(
+                "k-way merge of " + std::to_string(k) + " runs",
+                "kway-merge-" + std::to_string(k),
+                [k](PQ &queue, Configuration config, void*) {
+                    return kway_merge::fill(queue, config, k);
+                },
+                [k](PQ &queue, Configuration config, void* data) {
+                    kway_merge::run(queue, config, data, k);
+                },
+                kway_merge::check_sorted, configs, benchmarks);
+        }
+    }
+};
+
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Tournament tree of losers (Knuth, TAOCP 5.4.1) as a max-heap. Every
+/// element has a leaf, every inner node stores the leaf that lost the match
+/// there, and the overall winner is the top. After the winner's leaf changes,
+/// the path up from it is replayed against the stored losers, with one
+/// comparison per level and no comparisons between siblings.
+///
+/// Empty leaves hold the smallest value of T as a sentinel, so matches don't
+/// have to check for them. Elements that are equal to the sentinel are only
+/// counted, because they are indistinguishable from it and come out last.
+/// pop only marks the winner's leaf as free, and the replay happens at the
+/// next push, which reuses that leaf, or at the next top. A pop followed by a
+/// push of the next element of the same run, which is how k-way merging
+/// uses a queue, thus costs a single replay of log k comparisons.
+template <typename T,
+          typename Compare = std::less<T>>
+class loser_tree : public priority_queue<T> {
+    static_assert(std::is_arithmetic<T>::value && std::is_same<Compare, std::less<T>>::value,
+                  "loser_tree uses the smallest value of T as a sentinel");
+public:
+    loser_tree() : num_leaves(0), height(0), winner{T(), 0}, pending(none), in_tree(0), at_sentinel(0),
+                   sentinel(std::numeric_limits<T>::lowest())
+    {
+        grow();
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("loser tree", "loser-tree",
+            [](){ return new loser_tree<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        if (!comp(sentinel, value)) {
+            ++at_sentinel;
+            return;
+        }
+        if (pending != none) {
+            values[pending] = value;
+            replay(pending);
+            pending = none;
+        } else {
+            if (free_leaves.empty()) grow();
+            const size_t leaf = free_leaves.back();
+            free_leaves.pop_back();
+            values[leaf] = value;
+            update(leaf);
+        }
+        ++in_tree;
+    }
+    /// Add an element by rvalue reference, which is the same for arithmetic
+    /// types
+    void push(T&& value) override {
+        push(static_cast<const T&>(value));
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        if (in_tree == 0) {
+            --at_sentinel;
+            return;
+        }
+        settle();
+        values[winner.leaf] = sentinel;
+        pending = winner.leaf;
+        --in_tree;
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        if (in_tree == 0) return sentinel;
+        settle();
+        return winner.key;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return in_tree + at_sentinel;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new loser_tree();
+    }
+
+protected:
+    static constexpr size_t none = ~size_t(0);
+
+    // A leaf and a copy of its element, so that matches don't read the
+    // leaves
+    struct entry {
+        T key;
+        uint32_t leaf;
+    };
+
+    // Replay the matches on the path from the leaf of the previous winner to
+    // the root. The stored losers are the opponents of the previous winner.
+    // The winner of each match is selected with conditional moves instead of
+    // a branch, which would be mispredicted half of the time.
+    void replay(const size_t leaf) {
+        T key = values[leaf];
+        uint32_t index = static_cast<uint32_t>(leaf);
+        for (size_t node = (num_leaves + leaf) / 2; node > 0; node /= 2) {
+            entry &loser = losers[node];
+            const T loser_key = loser.key;
+            const uint32_t loser_index = loser.leaf;
+            // The stored loser wins the match if it is larger
+            const bool swap = comp(key, loser_key);
+            const uint32_t mask = -static_cast<uint32_t>(swap);
+            loser.key = swap ? key : loser_key;
+            loser.leaf = (index & mask) | (loser_index & ~mask);
+            key = swap ? loser_key : key;
+            index = (loser_index & mask) | (index & ~mask);
+        }
+        winner = entry{key, index};
+    }
+
+    // Replay the matches on the path from any other leaf to the root. Its
+    // opponents are the previous winners of the sibling subtrees, which are
+    // found on the way down from the root: the winner of a node's child is
+    // either the node's winner or its loser.
+    void update(const size_t leaf) {
+        entry path_winners[64];
+        size_t depth = 0;
+        path_winners[0] = winner;
+        for (size_t node = 1; node < num_leaves; ++depth) {
+            const size_t child = (num_leaves + leaf) >> (height - depth - 1);
+            const entry &w = path_winners[depth];
+            path_winners[depth + 1] = ((num_leaves + w.leaf) >> (height - depth - 1)) == child ? w : losers[node];
+            node = child;
+        }
+        entry w{values[leaf], static_cast<uint32_t>(leaf)};
+        for (size_t node = (num_leaves + leaf) / 2; node > 0; node /= 2) {
+            --depth;
+            // The winner of the node's other child
+            const entry other = path_winners[depth].leaf == path_winners[depth + 1].leaf ?
+                losers[node] : path_winners[depth];
+            if (comp(w.key, other.key)) {
+                losers[node] = w;
+                w = other;
+            } else {
+                losers[node] = other;
+            }
+        }
+        winner = w;
+    }
+
+    // Finish the replay of the leaf that pop removed the winner from
+    void settle() {
+        if (pending == none) return;
+        replay(pending);
+        free_leaves.push_back(pending);
+        pending = none;
+    }
+
+    // Double the number of leaves and rebuild the tree bottom-up
+    void grow() {
+        settle();
+        const size_t old_leaves = num_leaves;
+        num_leaves = old_leaves == 0 ? 2 : 2 * old_leaves;
+        height = __builtin_ctzll(num_leaves);
+        values.resize(num_leaves, sentinel);
+        // Use the lowest free leaves first
+        for (size_t leaf = num_leaves; leaf > old_leaves; --leaf) {
+            free_leaves.push_back(leaf - 1);
+        }
+        // Winners of the subtrees, node k's children are 2k and 2k + 1
+        std::vector<entry> winners(2 * num_leaves);
+        losers.resize(num_leaves);
+        for (size_t leaf = 0; leaf < num_leaves; ++leaf) {
+            winners[num_leaves + leaf] = entry{values[leaf], static_cast<uint32_t>(leaf)};
+        }
+        for (size_t node = num_leaves - 1; node > 0; --node) {
+            const entry &left = winners[2 * node], &right = winners[2 * node + 1];
+            const bool left_wins = !comp(left.key, right.key);
+            winners[node] = left_wins ? left : right;
+            losers[node] = left_wins ? right : left;
+        }
+        winner = winners[1];
+    }
+
+    Compare comp;
+    size_t num_leaves;             // a power of two
+    size_t height;                 // log2(num_leaves)
+    std::vector<T> values;         // the leaves, sentinel if free
+    std::vector<entry> losers;     // inner nodes 1 to num_leaves - 1
+    std::vector<size_t> free_leaves;
+    entry winner;
+    size_t pending;                // leaf removed by pop, not replayed yet
+    size_t in_tree, at_sentinel;   // elements in leaves and equal to sentinel
+    const T sentinel;
+};
+
+template <typename T, typename Compare>
+constexpr size_t loser_tree<T, Compare>::none;
+
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 #include <random>
+#include <string>
 #include <type_traits>
 #include <vector>
 #include <utility>
@@ -8,6 +11,7 @@
 #include "../common/benchmark.h"
 #include "../common/benchmark_util.h"
 #include "../common/contenders.h"
+#include "double_ended_priority_queue.h"
 
 namespace pq {
 
@@ -18,6 +22,7 @@ public:
     using Benchmark = common::benchmark<PQ, Configuration>;
     using BenchmarkFactory = common::contender_factory<Benchmark>;
     using T = typename PQ::value_type;
+    using DoubleEnded = double_ended_priority_queue<T>;
 
     static void* fill_data_permutation(PQ&, Configuration config, void*) {
         return common::util::fill_data_permutation<T>(
@@ -46,6 +51,122 @@ public:
         return fill_data_random<dfactor>(queue, config, data);
     }
 
+    // Keys of the monotone benchmark are at most this far below the last
+    // popped key, so a radix heap needs about log2(monotone_range) buckets
+    static constexpr size_t monotone_range = 1<<20;
+
+    // Push keys slightly below the middle of T's range. Monotone push-pops
+    // move them down by a few Range at most.
+    template <size_t Range = monotone_range>
+    static void* fill_both_monotone(PQ &queue, Configuration config, void* data) {
+        std::mt19937 random{config.second};
+        const T high = std::numeric_limits<T>::max() / 2;
+        for (size_t i = 0; i < config.first; ++i)
+            queue.push(static_cast<T>(high - static_cast<T>(random() % Range)));
+        config.second++; // "new" seed
+        return fill_data_random<1>(queue, config, data);
+    }
+
+    // Pop the top key and push a key that is up to Range - 1 below it
+    template <size_t Range = monotone_range>
+    static void monotone_push_pop(PQ &queue, Configuration config, void* ptr) {
+        T* data = static_cast<T*>(ptr);
+        for (size_t i = 0; i < config.first; ++i) {
+            const T key = queue.top();
+            queue.pop();
+            const T distance = static_cast<T>(static_cast<size_t>(data[i]) % Range);
+            queue.push(static_cast<T>(key - distance));
+        }
+    }
+
+    // Keys from [0, Range), like a few priority levels or small edge weights
+    template <size_t Range, int factor = 1>
+    static void* fill_data_bounded(PQ&, Configuration config, void*) {
+        std::mt19937 random{config.second};
+        return common::util::fill_data<T>(factor * config.first,
+            [&random](size_t) { return static_cast<T>(random() % Range); });
+    }
+
+    template <size_t Range>
+    static void* fill_heap_bounded(PQ& queue, Configuration config, void*) {
+        std::mt19937 random{config.second};
+        for (size_t i = 0; i < config.first; ++i)
+            queue.push(static_cast<T>(random() % Range));
+        return nullptr;
+    }
+
+    template <size_t Range>
+    static void* fill_both_bounded(PQ &queue, Configuration config, void* data) {
+        fill_heap_bounded<Range>(queue, config, data);
+        config.second++; // "new" seed
+        return fill_data_bounded<Range>(queue, config, data);
+    }
+
+    // Increments of the hold model, with a mean of about hold_mean
+    static constexpr size_t hold_mean = 1<<10;
+
+    static T hold_exponential(std::mt19937 &random) {
+        return static_cast<T>(std::exponential_distribution<double>(1.0 / hold_mean)(random));
+    }
+    static T hold_uniform(std::mt19937 &random) {
+        return static_cast<T>(random() % (2 * hold_mean));
+    }
+    // Mostly short increments and a few long ones
+    static T hold_bimodal(std::mt19937 &random) {
+        return static_cast<T>(random() % 10 == 0 ? random() % (16 * hold_mean) : random() % (hold_mean / 4));
+    }
+    // The sum of two uniform increments, with a peak in the middle
+    static T hold_triangular(std::mt19937 &random) {
+        return static_cast<T>(random() % hold_mean + random() % hold_mean);
+    }
+
+    // Number of holds, at least the size of the queue so that every event
+    // gets rescheduled, and enough that small queues run long enough
+    static size_t hold_operations(const size_t size) {
+        return std::max<size_t>(size, 1<<20);
+    }
+
+    // Schedule config.first events at the current time plus an increment
+    // and generate the increments of the holds. Time is negated, so it
+    // starts at the middle of T's range and goes down.
+    template <T (*Increment)(std::mt19937&)>
+    static void* fill_hold(PQ &queue, Configuration config, void*) {
+        std::mt19937 random{config.second};
+        const T now = std::numeric_limits<T>::max() / 2;
+        for (size_t i = 0; i < config.first; ++i)
+            queue.push(static_cast<T>(now - Increment(random)));
+        return common::util::fill_data<T>(hold_operations(config.first),
+            [&random](size_t) { return Increment(random); });
+    }
+
+    // Pop the next event and schedule it again at its time plus an increment
+    static void hold(PQ &queue, Configuration config, void* ptr) {
+        T* data = static_cast<T*>(ptr);
+        const size_t holds = hold_operations(config.first);
+        for (size_t i = 0; i < holds; ++i) {
+            const T time = queue.top();
+            queue.pop();
+            queue.push(static_cast<T>(time - data[i]));
+        }
+    }
+
+    // Push a key, then pop from the end that its lowest bit picks, like a
+    // queue that is kept at a fixed size by dropping both the best and the
+    // worst candidates. Queues that are not double-ended always pop the
+    // top, which is the push-pop-mix baseline.
+    static void double_ended_mix(PQ &queue, Configuration config, void* ptr) {
+        T* data = static_cast<T*>(ptr);
+        DoubleEnded *double_ended = dynamic_cast<DoubleEnded*>(&queue);
+        for (size_t i = 0; i < config.first; ++i) {
+            queue.push(data[i]);
+            if (double_ended != nullptr && data[i] % 2 == 0) {
+                double_ended->pop_min();
+            } else {
+                queue.pop();
+            }
+        }
+    }
+
     static void clear_data(PQ&, Configuration, void* data) {
         common::util::delete_data<T>(data);
     }
@@ -55,9 +176,10 @@ public:
             std::make_pair(1<<16, 0xDECAF),
             std::make_pair(1<<18, 0xBEEF),
             std::make_pair(1<<20, 0xC0FFEE),
-            //std::make_pair(1<<22, 0xF005BA11),
-            //std::make_pair(1<<24, 0xBA5EBA11),
-            //std::make_pair(1<<26, 0xCA55E77E)
+            // beyond the L3 cache
+            std::make_pair(1<<22, 0xF005BA11),
+            std::make_pair(1<<24, 0xBA5EBA11),
+            std::make_pair(1<<26, 0xCA55E77E)
         };
 
         common::register_benchmark("push", "push",  microbenchmark::fill_heap_random<1>, configs, benchmarks);
@@ -78,6 +200,50 @@ public:
                 }
             }, microbenchmark::clear_data, configs, benchmarks);
 
+        common::register_benchmark("push-pop-mix popping from both ends", "push-pop-min-mix",
+            microbenchmark::fill_both_random<1>, microbenchmark::double_ended_mix,
+            microbenchmark::clear_data, configs, benchmarks);
+
+        // Like Dijkstra's algorithm, where no pushed key may be ordered before
+        // the last popped one, which push-pop-mix violates. This is a
+        // max-heap, so pushed keys are at most as large as the popped one.
+        common::register_benchmark("monotone push-pop on full heap", "monotone-push-pop",
+            microbenchmark::fill_both_monotone<>, microbenchmark::monotone_push_pop<>,
+            microbenchmark::clear_data, configs, benchmarks);
+
+        // Keys from a small range, which the generators above don't produce:
+        // 16 priority levels, or edge weights below 1000 in Dijkstra's algorithm
+        register_bounded_benchmarks<16>(configs, benchmarks);
+        register_bounded_benchmarks<1000>(configs, benchmarks);
+        common::register_benchmark("monotone push-pop on full heap, steps below 1000",
+            "monotone-push-pop-1000",
+            microbenchmark::fill_both_monotone<1000>, microbenchmark::monotone_push_pop<1000>,
+            microbenchmark::clear_data, configs, benchmarks);
+
+        // The hold model of discrete event simulation: the queue holds a
+        // fixed number of events, and the next one is rescheduled at its
+        // time plus a random increment, from small to huge queues
+        const std::vector<Configuration> hold_configs{
+            std::make_pair(1<<4, 0x5EED),
+            std::make_pair(1<<8, 0xDECAF),
+            std::make_pair(1<<12, 0xBEEF),
+            std::make_pair(1<<16, 0xC0FFEE),
+            std::make_pair(1<<20, 0xF005BA11),
+            std::make_pair(1<<24, 0xBA5EBA11)
+        };
+        common::register_benchmark("hold model, exponential increments", "hold-exponential",
+            microbenchmark::fill_hold<microbenchmark::hold_exponential>, microbenchmark::hold,
+            microbenchmark::clear_data, hold_configs, benchmarks);
+        common::register_benchmark("hold model, uniform increments", "hold-uniform",
+            microbenchmark::fill_hold<microbenchmark::hold_uniform>, microbenchmark::hold,
+            microbenchmark::clear_data, hold_configs, benchmarks);
+        common::register_benchmark("hold model, bimodal increments", "hold-bimodal",
+            microbenchmark::fill_hold<microbenchmark::hold_bimodal>, microbenchmark::hold,
+            microbenchmark::clear_data, hold_configs, benchmarks);
+        common::register_benchmark("hold model, triangular increments", "hold-triangular",
+            microbenchmark::fill_hold<microbenchmark::hold_triangular>, microbenchmark::hold,
+            microbenchmark::clear_data, hold_configs, benchmarks);
+
         common::register_benchmark("(push-pop-push)^n (pop-push-pop)^n", "idi^n-did^n",
             microbenchmark::fill_data_random<3>,
             [](PQ &queue, Configuration config, void* ptr) {
@@ -95,5 +261,30 @@ public:
                 }
             }, microbenchmark::clear_data, configs, benchmarks);
     }
+
+protected:
+    template <size_t Range>
+    static void register_bounded_benchmarks(const std::vector<Configuration> &configs,
+                                            common::contender_list<Benchmark> &benchmarks) {
+        const std::string range = std::to_string(Range);
+        common::register_benchmark("push, keys below " + range, "push-bounded-" + range,
+            microbenchmark::fill_heap_bounded<Range>, configs, benchmarks);
+
+        common::register_benchmark("push-pop-mix on full heap, keys below " + range,
+            "push-pop-mix-bounded-" + range,
+            microbenchmark::fill_both_bounded<Range>,
+            [](PQ &queue, Configuration config, void* ptr) {
+                T* data = static_cast<T*>(ptr);
+                for (size_t i = 0; i < config.first; ++i) {
+                    queue.push(data[i]);
+                    queue.pop();
+                }
+            }, microbenchmark::clear_data, configs, benchmarks);
+    }
 };
+
+template <typename PQ>
+constexpr size_t microbenchmark<PQ>::monotone_range;
+template <typename PQ>
+constexpr size_t microbenchmark<PQ>::hold_mean;
 }
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "double_ended_priority_queue.h"
+
+namespace pq {
+
+/// Min-max heap (Atkinson et al. 1986), a binary heap whose levels
+/// alternate between max and min levels, starting with a max level at the
+/// root. An element on a max level is at least as large as all elements in
+/// its subtree, one on a min level at most as large. So the largest element
+/// is the root and the smallest one of its children, and both ends can be
+/// popped in O(log n). Sifting compares an element with its grandparents or
+/// grandchildren, which skips every other level.
+template <typename T,
+          typename Compare = std::less<T>>
+class min_max_heap : public double_ended_priority_queue<T> {
+public:
+    min_max_heap() {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("min-max heap", "min-max-heap",
+            [](){ return new min_max_heap<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        data.push_back(value);
+        sift_up(size() - 1);
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        data.push_back(std::move(value));
+        sift_up(size() - 1);
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        remove(0);
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        return data[0];
+    }
+
+    /// Deletes the bottom element
+    void pop_min() override {
+        assert(size() > 0);
+        remove(min_index());
+    }
+
+    /// Retrieves the bottom element
+    const T& top_min() override {
+        assert(size() > 0);
+        return data[min_index()];
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return data.size();
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new min_max_heap();
+    }
+
+protected:
+    // Depth of k counted from 0 at the root, even depths are max levels
+    static bool on_max_level(const size_t k) {
+        return (63 - __builtin_clzll(k + 1)) % 2 == 0;
+    }
+
+    // Whether a should be closer to the root than b on a max or min level
+    bool before(const bool max_level, const T &a, const T &b) const {
+        return max_level ? comp(b, a) : comp(a, b);
+    }
+
+    size_t min_index() {
+        if (size() <= 2) return size() - 1;
+        return comp(data[2], data[1]) ? 2 : 1;
+    }
+
+    // Replace the element at k with the last one
+    void remove(const size_t k) {
+        T value = std::move(data.back());
+        data.pop_back();
+        if (k < size()) {
+            data[k] = std::move(value);
+            sift_down(k);
+        }
+    }
+
+    // Move a new element at k up. If it belongs to the other kind of level
+    // than k's, it first swaps with the parent. After that it only moves
+    // up on its kind of level, from grandparent to grandparent.
+    void sift_up(size_t k) {
+        if (k == 0) return;
+        bool max_level = on_max_level(k);
+        const size_t parent = (k - 1) / 2;
+        if (before(!max_level, data[k], data[parent])) {
+            std::swap(data[k], data[parent]);
+            k = parent;
+            max_level = !max_level;
+        }
+        while (k > 2) {
+            const size_t grandparent = (k - 3) / 4;
+            if (!before(max_level, data[k], data[grandparent])) break;
+            std::swap(data[k], data[grandparent]);
+            k = grandparent;
+        }
+    }
+
+    // Move the element at k down on its kind of level, swapping it with the
+    // extreme one of its children and grandchildren
+    void sift_down(size_t k) {
+        const bool max_level = on_max_level(k);
+        const size_t n = size();
+        while (2 * k + 1 < n) {
+            // The extreme one of up to two children and four grandchildren
+            size_t best = 2 * k + 1;
+            if (best + 1 < n && before(max_level, data[best + 1], data[best])) best = best + 1;
+            const size_t first = 4 * k + 3, last = std::min(first + 4, n);
+            bool grandchild = false;
+            for (size_t g = first; g < last; ++g) {
+                if (before(max_level, data[g], data[best])) {
+                    best = g;
+                    grandchild = true;
+                }
+            }
+            if (!before(max_level, data[best], data[k])) return;
+            std::swap(data[best], data[k]);
+            if (!grandchild) return;
+            // The element from k may belong above the grandchild's parent
+            const size_t parent = (best - 1) / 2;
+            if (before(!max_level, data[best], data[parent])) {
+                std::swap(data[best], data[parent]);
+            }
+            k = best;
+        }
+    }
+
+    Compare comp;
+    std::vector<T> data;
+};
+
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../common/aligned_allocator.h"
+#include "../common/contenders.h"
+#include "dary_heap.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// MultiQueue (Rihani, Sanders, Dementiev 2015), a relaxed concurrent
+/// max-heap made of c * P sequential heaps for P threads, each protected by
+/// a try-lock. push adds to a random heap that is not locked, try_pop looks
+/// at the tops of two random heaps and pops from the better one. Popped
+/// elements are not always the largest, but their expected rank is O(c * P),
+/// and threads rarely wait for each other.
+///
+/// Every heap publishes its top element in an atomic, so that try_pop can
+/// compare heaps without locking them, which is why T must be trivially
+/// copyable. top() and pop() look at all heaps and are exact.
+template <typename T,
+          typename Compare = std::less<T>>
+class multiqueue : public priority_queue<T> {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "multiqueue publishes the top elements in atomics");
+public:
+    explicit multiqueue(const size_t num_queues)
+        : queues(std::max<size_t>(num_queues, 2)) {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        const size_t threads = std::max(1u, std::thread::hardware_concurrency());
+        list.register_contender(Factory("multiqueue, c=2", "multiqueue-2",
+            [threads](){ return new multiqueue<T>(2 * threads); }
+        ));
+        list.register_contender(Factory("multiqueue, c=4", "multiqueue-4",
+            [threads](){ return new multiqueue<T>(4 * threads); }
+        ));
+    }
+
+    /// Add an element to a random heap that is not locked
+    void push(const T& value) override {
+        uint64_t &state = random_state();
+        sub_queue *q;
+        do {
+            q = &queues[next_random(state) % queues.size()];
+        } while (!q->try_lock());
+        q->heap.push(value);
+        q->publish();
+        q->unlock();
+    }
+    /// Add an element by rvalue reference, which is the same for trivially
+    /// copyable elements
+    void push(T&& value) override {
+        push(static_cast<const T&>(value));
+    }
+
+    /// Pop the top element of the better one of two random heaps
+    bool try_pop(T &out) override {
+        uint64_t &state = random_state();
+        size_t misses = 0;
+        while (true) {
+            sub_queue &a = queues[next_random(state) % queues.size()];
+            sub_queue &b = queues[next_random(state) % queues.size()];
+            sub_queue *q = better(a, b);
+            if (q == nullptr) {
+                // Both looked empty, check all heaps once in a while
+                if (++misses < queues.size()) continue;
+                if (all_empty()) return false;
+                misses = 0;
+                continue;
+            }
+            if (!q->try_lock()) continue;
+            if (q->heap.size() == 0) {
+                q->unlock();
+                continue;
+            }
+            out = q->heap.top();
+            q->heap.pop();
+            q->publish();
+            q->unlock();
+            return true;
+        }
+    }
+
+    bool concurrent() const override {
+        return true;
+    }
+
+    /// Deletes the top element of all heaps
+    void pop() override {
+        sub_queue &q = queues[best_queue()];
+        q.heap.pop();
+        q.publish();
+    }
+
+    /// Retrieves the top element of all heaps
+    const T& top() override {
+        return queues[best_queue()].heap.top();
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        size_t num = 0;
+        for (auto &q : queues) {
+            num += q.heap.size();
+        }
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new multiqueue(queues.size());
+    }
+
+protected:
+    struct alignas(64) sub_queue {
+        sub_queue() : locked(false), nonempty(false), top(T()) {}
+
+        bool try_lock() {
+            return !locked.load(std::memory_order_relaxed) &&
+                   !locked.exchange(true, std::memory_order_acquire);
+        }
+
+        void unlock() {
+            locked.store(false, std::memory_order_release);
+        }
+
+        // Publish the heap's top element after a change, while locked
+        void publish() {
+            const bool any = heap.size() > 0;
+            if (any) top.store(heap.top(), std::memory_order_relaxed);
+            nonempty.store(any, std::memory_order_release);
+        }
+
+        std::atomic<bool> locked;
+        std::atomic<bool> nonempty;
+        std::atomic<T> top;
+        dary_heap<T, 8, Compare> heap;
+    };
+
+    // The heap with the larger published top, or nullptr if both look empty
+    sub_queue* better(sub_queue &a, sub_queue &b) {
+        const bool has_a = a.nonempty.load(std::memory_order_acquire);
+        const bool has_b = b.nonempty.load(std::memory_order_acquire);
+        if (!has_a) return has_b ? &b : nullptr;
+        if (!has_b) return &a;
+        return comp(a.top.load(std::memory_order_relaxed), b.top.load(std::memory_order_relaxed)) ? &b : &a;
+    }
+
+    bool all_empty() const {
+        for (auto &q : queues) {
+            if (q.nonempty.load(std::memory_order_acquire)) return false;
+        }
+        return true;
+    }
+
+    // Index of the heap with the largest top element, if nothing else runs
+    size_t best_queue() {
+        size_t best = queues.size();
+        for (size_t i = 0; i < queues.size(); ++i) {
+            if (queues[i].heap.size() == 0) continue;
+            if (best == queues.size() || comp(queues[best].heap.top(), queues[i].heap.top())) {
+                best = i;
+            }
+        }
+        assert(best < queues.size());
+        return best;
+    }
+
+    // Every thread has its own xorshift state for choosing heaps
+    static uint64_t& random_state() {
+        static std::atomic<uint64_t> threads{0};
+        thread_local uint64_t state =
+            (threads.fetch_add(1, std::memory_order_relaxed) + 1) * 0x9E3779B97F4A7C15ull;
+        return state;
+    }
+
+    static uint64_t next_random(uint64_t &state) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        return state;
+    }
+
+    Compare comp;
+    std::vector<sub_queue, common::aligned_allocator<sub_queue>> queues;
+};
+
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "../common/node_pool.h"
+#include "addressable_priority_queue.h"
+
+namespace pq {
+
+/// Pairing heap (Fredman, Sedgewick, Sleator, Tarjan 1986) as a max-heap.
+/// Every node keeps a list of its children, starting with its first child
+/// and linked through the siblings. pop links the root's children into a
+/// single tree, either in two passes (pairs from left to right, then the
+/// results from right to left) or, if Multipass is set, by repeatedly
+/// linking the first two trees and appending the result to the end.
+/// Nodes come from a pool, and the destructor is iterative, so deep heaps
+/// don't overflow the stack.
+template <typename T,
+          bool Multipass = false,
+          typename Compare = std::less<T>>
+class pairing_heap : public addressable_priority_queue<T> {
+public:
+    using handle = typename addressable_priority_queue<T>::handle;
+
+    pairing_heap() : root(nullptr), num(0) {}
+    pairing_heap(const pairing_heap&) = delete;
+
+    virtual ~pairing_heap() {
+        destroy_all();
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("pairing heap", "pairing-heap",
+            [](){ return new pairing_heap<T>(); }
+        ));
+        list.register_contender(Factory("pairing heap, multipass", "pairing-heap-multipass",
+            [](){ return new pairing_heap<T, true>(); }
+        ));
+    }
+
+    /// Add an element by const lvalue reference and return a handle to it
+    handle insert(const T& value) override {
+        return add(pool.create(value));
+    }
+    /// Add an element by rvalue reference (with move) and return a handle to it
+    handle insert(T&& value) override {
+        return add(pool.create(std::move(value)));
+    }
+
+    /// Move an element towards the top by replacing it with value
+    void decrease_key(handle h, const T& value) override {
+        node *n = static_cast<node*>(h);
+        assert(!comp(value, n->value));
+        n->value = value;
+        if (n != root) {
+            cut(n);
+            root = link(root, n);
+        }
+    }
+
+    /// Remove an element
+    void erase(handle h) override {
+        node *n = static_cast<node*>(h);
+        if (n == root) {
+            pop();
+            return;
+        }
+        cut(n);
+        node *children = combine(n->child);
+        if (children != nullptr) root = link(root, children);
+        pool.destroy(n);
+        --num;
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        node *old = root;
+        root = combine(root->child);
+        pool.destroy(old);
+        --num;
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return root->value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new pairing_heap();
+    }
+
+    /// Move all elements of other into this heap, in constant time if it is
+    /// a pairing heap of the same type. Handles into other stay valid.
+    void meld(priority_queue<T> &&other) override {
+        auto *o = dynamic_cast<pairing_heap*>(&other);
+        if (o == nullptr || o == this) {
+            priority_queue<T>::meld(std::move(other));
+            return;
+        }
+        if (o->root != nullptr) {
+            root = (root == nullptr) ? o->root : link(root, o->root);
+        }
+        num += o->num;
+        pool.absorb(o->pool);
+        o->root = nullptr;
+        o->num = 0;
+    }
+
+protected:
+    struct node {
+        template <typename V>
+        explicit node(V &&value)
+            : value(std::forward<V>(value)), child(nullptr), next(nullptr), prev(nullptr) {}
+
+        T value;
+        node *child; // first child
+        node *next;  // next sibling
+        node *prev;  // previous sibling, or the parent for the first child
+    };
+
+    handle add(node *n) {
+        root = (root == nullptr) ? n : link(root, n);
+        ++num;
+        return n;
+    }
+
+    // Make the root with the smaller value the first child of the other.
+    // Both must be roots of trees, their sibling pointers are overwritten.
+    node* link(node *a, node *b) {
+        if (comp(a->value, b->value)) std::swap(a, b);
+        b->prev = a;
+        b->next = a->child;
+        if (a->child != nullptr) a->child->prev = b;
+        a->child = b;
+        a->next = a->prev = nullptr;
+        return a;
+    }
+
+    // Detach a node that is not the root from its parent and siblings
+    void cut(node *n) {
+        if (n->prev->child == n) {
+            n->prev->child = n->next;
+        } else {
+            n->prev->next = n->next;
+        }
+        if (n->next != nullptr) n->next->prev = n->prev;
+        n->next = n->prev = nullptr;
+    }
+
+    // Link a list of siblings into a single tree
+    node* combine(node *first) {
+        if (first == nullptr) return nullptr;
+        node *result = Multipass ? combine_multipass(first) : combine_two_pass(first);
+        result->next = result->prev = nullptr;
+        return result;
+    }
+
+    node* combine_two_pass(node *first) {
+        // Link pairs from left to right, collecting the results in reverse
+        node *pairs = nullptr;
+        while (first != nullptr) {
+            node *a = first, *b = first->next;
+            if (b == nullptr) {
+                a->next = pairs;
+                pairs = a;
+                break;
+            }
+            first = b->next;
+            node *linked = link(a, b);
+            linked->next = pairs;
+            pairs = linked;
+        }
+        // Link them from right to left
+        node *result = pairs;
+        pairs = pairs->next;
+        while (pairs != nullptr) {
+            node *next = pairs->next;
+            result = link(result, pairs);
+            pairs = next;
+        }
+        return result;
+    }
+
+    node* combine_multipass(node *first) {
+        // The siblings form a FIFO queue
+        node *last = first;
+        while (last->next != nullptr) last = last->next;
+        while (first != last) {
+            node *a = first, *b = first->next;
+            first = b->next;
+            node *linked = link(a, b);
+            if (first == nullptr) return linked;
+            last->next = linked;
+            last = linked;
+        }
+        return first;
+    }
+
+    // Destroy all elements without recursion. The pool frees the memory.
+    void destroy_all() {
+        if (std::is_trivially_destructible<T>::value || root == nullptr) return;
+        std::vector<node*> stack{root};
+        while (!stack.empty()) {
+            node *n = stack.back();
+            stack.pop_back();
+            for (node *c = n->child; c != nullptr; c = c->next) {
+                stack.push_back(c);
+            }
+            pool.destroy(n);
+        }
+    }
+
+    Compare comp;
+    common::node_pool<node> pool;
+    node *root;
+    size_t num;
+};
+
+}
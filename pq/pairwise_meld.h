@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+
+namespace pq {
+
+template <typename PQ>
+class pairwise_meld {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+
+    // The benchmarked queue and K - 1 more of the same type
+    using queues = std::vector<std::unique_ptr<PQ>>;
+
+    /// Distribute config.first random elements over the benchmarked queue
+    /// and K - 1 empty queues created from it
+    template <size_t K>
+    static void* fill(PQ &queue, Configuration config, void*) {
+        std::mt19937 random{config.second};
+        queues *others = new queues;
+        for (size_t k = 1; k < K; ++k) {
+            others->emplace_back(queue.create_empty());
+        }
+        for (size_t i = 0; i < config.first; ++i) {
+            const size_t k = i % K;
+            PQ &target = (k == 0) ? queue : *(*others)[k - 1];
+            target.push(static_cast<T>(random()));
+        }
+        return others;
+    }
+
+    static void clear(PQ&, Configuration, void* data) {
+        delete static_cast<queues*>(data);
+    }
+
+    /// Meld the queues pairwise in rounds like a tournament until the
+    /// benchmarked queue holds all elements, then pop the share of one
+    /// queue, so that queues which meld lazily do their deferred work
+    template <size_t K>
+    static void run(PQ &queue, Configuration config, void* data) {
+        queues &others = *static_cast<queues*>(data);
+        auto at = [&](const size_t k) -> PQ& { return (k == 0) ? queue : *others[k - 1]; };
+        for (size_t step = 1; step < K; step *= 2) {
+            for (size_t k = 0; k + step < K; k += 2 * step) {
+                at(k).meld(std::move(at(k + step)));
+            }
+        }
+        for (size_t i = 0; i < config.first / K; ++i) {
+            queue.pop();
+        }
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<16, 0xDECAF),
+            std::make_pair(1<<18, 0xBEEF),
+            std::make_pair(1<<20, 0xC0FFEE),
+            // beyond the L3 cache
+            std::make_pair(1<<22, 0xF005BA11)
+        };
+
+        common::register_benchmark("meld 16 queues pairwise", "meld-16",
+            pairwise_meld::fill<16>, pairwise_meld::run<16>, pairwise_meld::clear,
+            configs, benchmarks);
+        common::register_benchmark("meld 1024 queues pairwise", "meld-1024",
+            pairwise_meld::fill<1024>, pairwise_meld::run<1024>, pairwise_meld::clear,
+            configs, benchmarks);
+    }
+};
+
+}
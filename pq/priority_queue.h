@@ -24,6 +24,55 @@ public:
     /// Get the number of elements in the priority queue
     virtual size_t size() = 0;
 
+    /// Add the elements in [first, last). This generic version pushes one
+    /// element at a time, array-based queues should override it to build
+    /// their structure in linear time. Virtual functions can't be templates,
+    /// so the range is given by pointers.
+    virtual void push_bulk(const T *first, const T *last) {
+        for (; first != last; ++first) {
+            push(*first);
+        }
+    }
+
+    /// Remove the n top elements and write them to out in the order in which
+    /// they would be popped. There must be at least n elements.
+    virtual void pop_n(size_t n, T *out) {
+        for (; n > 0; --n) {
+            *out++ = top();
+            pop();
+        }
+    }
+
+    /// Whether push() and try_pop() may be called from many threads at once.
+    /// All other functions must not run concurrently with anything else.
+    virtual bool concurrent() const { return false; }
+
+    /// Remove an element and write it to out, or return false if the queue
+    /// is empty. Relaxed concurrent queues may remove an element close to
+    /// the top instead of the top element. This generic version pops the
+    /// top element.
+    virtual bool try_pop(T &out) {
+        if (size() == 0) return false;
+        out = top();
+        pop();
+        return true;
+    }
+
+    /// Create a new, empty priority queue of the same type
+    virtual priority_queue* create_empty() const = 0;
+
+    /// Move all elements of other into this priority queue, leaving other
+    /// empty. This generic version pops and pushes one element at a time,
+    /// implementations should override it to link structures of their own
+    /// type.
+    virtual void meld(priority_queue &&other) {
+        if (&other == this) return;
+        while (other.size() > 0) {
+            push(other.top());
+            other.pop();
+        }
+    }
+
     /// Virtual destructor needed for inheritance
     virtual ~priority_queue() {}
 };
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "dary_heap.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Radix heap (Ahuja, Mehlhorn, Orlin, Tarjan 1990) for unsigned integers as
+/// a max-heap. It is made for monotone workloads, in which no pushed key is
+/// larger than the last popped one, like Dijkstra's algorithm with negated
+/// distances. Bucket i > 0 holds the keys whose highest bit that differs from
+/// the last popped key is bit i - 1, bucket 0 the keys equal to it. Popping
+/// from an empty bucket 0 finds the largest key of the first nonempty bucket,
+/// which becomes the new reference, and moves the bucket's keys to lower
+/// buckets. Every key moves at most log C times for keys in a range of C, and
+/// buckets are scanned sequentially.
+///
+/// Keys larger than the last popped one go to a d-ary heap instead, so that
+/// the queue stays correct for non-monotone workloads.
+template <typename T>
+class radix_heap : public priority_queue<T> {
+    static_assert(std::is_integral<T>::value && std::is_unsigned<T>::value,
+                  "radix_heap needs unsigned integer elements");
+    static_assert(std::numeric_limits<T>::digits <= 64, "Bucket mask holds 64 buckets");
+    static constexpr int bits = std::numeric_limits<T>::digits;
+public:
+    radix_heap() : last(std::numeric_limits<T>::max()), occupied(0), num(0) {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("radix heap", "radix-heap",
+            [](){ return new radix_heap<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        if (value > last) {
+            fallback.push(value);
+        } else {
+            const int b = bucket_of(value);
+            buckets[b].push_back(value);
+            if (b > 0) occupied |= uint64_t(1) << (b - 1);
+        }
+        ++num;
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        push(static_cast<const T&>(value));
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        if (top_in_fallback()) {
+            fallback.pop();
+        } else {
+            buckets[0].pop_back();
+        }
+        --num;
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return top_in_fallback() ? fallback.top() : buckets[0].back();
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new radix_heap();
+    }
+
+protected:
+    // Index of the bucket that holds value relative to the last popped key
+    int bucket_of(const T value) const {
+        const uint64_t diff = static_cast<uint64_t>(value ^ last);
+        return diff == 0 ? 0 : 64 - __builtin_clzll(diff);
+    }
+
+    // Whether the top element is in the fallback heap. Refills bucket 0 if
+    // it is empty and other buckets are not.
+    bool top_in_fallback() {
+        if (buckets[0].empty()) {
+            if (occupied == 0) return true;
+            redistribute();
+        }
+        return fallback.size() > 0 && buckets[0].back() < fallback.top();
+    }
+
+    // Make the largest key of the first nonempty bucket the new reference
+    // and move that bucket's keys to lower buckets
+    void redistribute() {
+        const int b = __builtin_ctzll(occupied) + 1;
+        std::vector<T> &source = buckets[b];
+        T largest = source[0];
+        for (const T value : source) {
+            if (largest < value) largest = value;
+        }
+        last = largest;
+        occupied &= ~(uint64_t(1) << (b - 1));
+        for (const T value : source) {
+            const int target = bucket_of(value);
+            assert(target < b);
+            buckets[target].push_back(value);
+            if (target > 0) occupied |= uint64_t(1) << (target - 1);
+        }
+        source.clear();
+    }
+
+    T last; // the last popped key, or the largest key before the first pop
+    std::vector<T> buckets[bits + 1];
+    uint64_t occupied; // bit i - 1 is set if bucket i > 0 is nonempty
+    dary_heap<T> fallback;
+    size_t num;
+};
+
+template <typename T>
+constexpr int radix_heap<T>::bits;
+
+}
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "../common/node_pool.h"
+#include "addressable_priority_queue.h"
+
+namespace pq {
+
+/// Rank-pairing heap (Haeupler, Sen, Tarjan 2011) as a max-heap. The heap is
+/// a list of half trees: binary trees whose roots have no right child, in
+/// which every node is at least as large as the nodes in its left subtree.
+/// insert adds a root. pop turns the right spine of the largest root's left
+/// subtree into new roots and links roots of equal rank, each at most once.
+/// erase removes an element the same way.
+/// decrease_key cuts a node with its left subtree, puts its right subtree
+/// in its place, and lowers the ranks of its ancestors where the rank rule
+/// of Type (1 or 2) allows. Type 2 allows more rank differences, so it
+/// changes fewer ranks. Nodes come from a pool, and the destructor is
+/// iterative.
+template <typename T,
+          int Type = 1,
+          typename Compare = std::less<T>>
+class rank_pairing_heap : public addressable_priority_queue<T> {
+    static_assert(Type == 1 || Type == 2, "Rank-pairing heaps are of type 1 or 2");
+public:
+    using handle = typename addressable_priority_queue<T>::handle;
+
+    rank_pairing_heap() : max(nullptr), num(0) {}
+    rank_pairing_heap(const rank_pairing_heap&) = delete;
+
+    virtual ~rank_pairing_heap() {
+        destroy_all();
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("rank-pairing heap, type 1", "rank-pairing-heap-1",
+            [](){ return new rank_pairing_heap<T, 1>(); }
+        ));
+        list.register_contender(Factory("rank-pairing heap, type 2", "rank-pairing-heap-2",
+            [](){ return new rank_pairing_heap<T, 2>(); }
+        ));
+    }
+
+    /// Add an element by const lvalue reference and return a handle to it
+    handle insert(const T& value) override {
+        node *n = pool.create(value);
+        add_root(n);
+        ++num;
+        return n;
+    }
+    /// Add an element by rvalue reference (with move) and return a handle to it
+    handle insert(T&& value) override {
+        node *n = pool.create(std::move(value));
+        add_root(n);
+        ++num;
+        return n;
+    }
+
+    /// Move an element towards the top by replacing it with value
+    void decrease_key(handle h, const T& value) override {
+        node *n = static_cast<node*>(h);
+        assert(!comp(value, n->value));
+        n->value = value;
+        if (n->parent == nullptr) {
+            if (comp(max->value, n->value)) max = n;
+            return;
+        }
+        cut(n);
+        add_root(n);
+    }
+
+    /// Remove an element
+    void erase(handle h) override {
+        node *n = static_cast<node*>(h);
+        if (n->parent != nullptr) {
+            cut(n);
+            add_root(n);
+        }
+        // Remove it as if it was the largest element
+        max = n;
+        remove_root(n);
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        remove_root(max);
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return max->value;
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new rank_pairing_heap();
+    }
+
+    /// Move all elements of other into this heap, in constant time if it is
+    /// a rank-pairing heap of the same type. Handles into other stay valid.
+    void meld(priority_queue<T> &&other) override {
+        auto *o = dynamic_cast<rank_pairing_heap*>(&other);
+        if (o == nullptr || o == this) {
+            priority_queue<T>::meld(std::move(other));
+            return;
+        }
+        if (o->max != nullptr) {
+            if (max == nullptr) {
+                max = o->max;
+            } else {
+                // Concatenate the root lists
+                std::swap(max->right, o->max->right);
+                if (comp(max->value, o->max->value)) max = o->max;
+            }
+        }
+        num += o->num;
+        pool.absorb(o->pool);
+        o->max = nullptr;
+        o->num = 0;
+    }
+
+protected:
+    struct node {
+        template <typename V>
+        explicit node(V &&value)
+            : value(std::forward<V>(value)), parent(nullptr), left(nullptr),
+              right(nullptr), rank(0) {}
+
+        T value;
+        node *parent; // nullptr for roots
+        node *left;
+        node *right;  // for roots, the next root in the circular root list
+        int rank;
+    };
+
+    static int rank(const node *n) {
+        return n == nullptr ? -1 : n->rank;
+    }
+
+    // Insert a half tree into the root list after max and update max
+    void add_root(node *n) {
+        n->parent = nullptr;
+        n->rank = rank(n->left) + 1;
+        if (max == nullptr) {
+            n->right = n;
+            max = n;
+            return;
+        }
+        n->right = max->right;
+        max->right = n;
+        if (comp(max->value, n->value)) max = n;
+    }
+
+    // Detach a node that is not a root with its left subtree, replace it by
+    // its right subtree and restore the rank rule on the path to the root
+    void cut(node *n) {
+        node *parent = n->parent, *right = n->right;
+        if (parent->left == n) {
+            parent->left = right;
+        } else {
+            parent->right = right;
+        }
+        if (right != nullptr) right->parent = parent;
+        n->right = nullptr;
+
+        for (node *u = parent; ; u = u->parent) {
+            if (u->parent == nullptr) {
+                u->rank = rank(u->left) + 1;
+                break;
+            }
+            const int k = rank(u->left), l = rank(u->right);
+            int r;
+            if (Type == 1) {
+                r = (k == l) ? k + 1 : std::max(k, l);
+            } else {
+                r = (std::abs(k - l) > 1) ? std::max(k, l) : std::max(k, l) + 1;
+            }
+            if (r >= u->rank) break;
+            u->rank = r;
+        }
+    }
+
+    // Make the root with the smaller value the left child of the other,
+    // which gets a rank higher than the loser's
+    node* link(node *a, node *b) {
+        if (comp(a->value, b->value)) std::swap(a, b);
+        b->parent = a;
+        b->right = a->left;
+        if (b->right != nullptr) b->right->parent = b;
+        a->left = b;
+        a->rank = b->rank + 1;
+        return a;
+    }
+
+    // Remove and destroy the maximum, link roots of equal rank at most once
+    // and find the new maximum
+    void remove_root(node *r) {
+        assert(r == max);
+        max = nullptr;
+        buckets.clear();
+        auto one_pass = [this](node *n) {
+            const size_t k = n->rank;
+            if (buckets.size() <= k) buckets.resize(k + 1, nullptr);
+            if (buckets[k] == nullptr) {
+                buckets[k] = n;
+            } else {
+                node *other = buckets[k];
+                buckets[k] = nullptr;
+                add_root(link(other, n));
+            }
+        };
+        // The right spine of the left subtree becomes new roots
+        for (node *n = r->left; n != nullptr; ) {
+            node *next = n->right;
+            n->right = nullptr;
+            n->parent = nullptr;
+            n->rank = rank(n->left) + 1;
+            one_pass(n);
+            n = next;
+        }
+        for (node *n = r->right; n != r; ) {
+            node *next = n->right;
+            one_pass(n);
+            n = next;
+        }
+        for (node *n : buckets) {
+            if (n != nullptr) add_root(n);
+        }
+        pool.destroy(r);
+        --num;
+    }
+
+    // Destroy all elements without recursion. The pool frees the memory.
+    void destroy_all() {
+        if (std::is_trivially_destructible<T>::value || max == nullptr) return;
+        std::vector<node*> stack;
+        node *r = max;
+        do {
+            if (r->left != nullptr) stack.push_back(r->left);
+            node *next = r->right;
+            pool.destroy(r);
+            r = next;
+        } while (r != max);
+        while (!stack.empty()) {
+            node *n = stack.back();
+            stack.pop_back();
+            if (n->left != nullptr) stack.push_back(n->left);
+            if (n->right != nullptr) stack.push_back(n->right);
+            pool.destroy(n);
+        }
+    }
+
+    Compare comp;
+    common::node_pool<node> pool;
+    node *max;
+    size_t num;
+    std::vector<node*> buckets; // used by remove_root
+};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace pq {
+
+/// Elements that are records of a 64-bit key and a payload, like the events
+/// of a simulation, for benchmarks of the cost of moving elements that are
+/// larger than an int. Every record type is ordered by its key first, so a
+/// smaller key means a smaller record. record_traits<T> gives the key of a
+/// record and makes records from a key and an id. It is only specialized
+/// for record types, see is_record.
+template <typename T>
+struct record_traits {
+    static constexpr bool is_record = false;
+};
+
+/// 16-byte record of a key and an id, ordered by both
+using pair_record = std::pair<uint64_t, uint64_t>;
+
+template <>
+struct record_traits<pair_record> {
+    static constexpr bool is_record = true;
+    static uint64_t key(const pair_record &record) { return record.first; }
+    static pair_record make(const uint64_t key, const uint64_t id) { return pair_record(key, id); }
+};
+
+/// 32-byte record that is copied by value, ordered by its key only
+struct record32 {
+    uint64_t key;
+    uint64_t payload[3];
+
+    friend bool operator<(const record32 &a, const record32 &b) {
+        return a.key < b.key;
+    }
+    friend bool operator==(const record32 &a, const record32 &b) {
+        return a.key == b.key && a.payload[0] == b.payload[0] &&
+               a.payload[1] == b.payload[1] && a.payload[2] == b.payload[2];
+    }
+};
+static_assert(sizeof(record32) == 32, "record32 should fill half a cache line");
+
+template <>
+struct record_traits<record32> {
+    static constexpr bool is_record = true;
+    static uint64_t key(const record32 &record) { return record.key; }
+    static record32 make(const uint64_t key, const uint64_t id) { return record32{key, {id, ~id, key ^ id}}; }
+};
+
+/// Record with its payload on the heap, ordered by its key only. Copying it
+/// allocates a new payload, moving it only moves the pointer, so queues that
+/// copy elements instead of moving them pay for it.
+class boxed_record {
+public:
+    struct payload_type {
+        uint64_t id;
+        uint64_t data[4];
+    };
+
+    boxed_record() : key(0) {}
+    boxed_record(const uint64_t key, const uint64_t id)
+        : key(key), payload(new payload_type{id, {key, id, ~key, ~id}}) {}
+    boxed_record(const boxed_record &other)
+        : key(other.key), payload(other.payload ? new payload_type(*other.payload) : nullptr) {}
+    boxed_record(boxed_record &&other) = default;
+
+    boxed_record& operator=(const boxed_record &other) {
+        boxed_record copy(other);
+        return *this = std::move(copy);
+    }
+    boxed_record& operator=(boxed_record &&other) = default;
+
+    uint64_t id() const {
+        return payload ? payload->id : 0;
+    }
+
+    friend bool operator<(const boxed_record &a, const boxed_record &b) {
+        return a.key < b.key;
+    }
+    friend bool operator==(const boxed_record &a, const boxed_record &b) {
+        return a.key == b.key && a.id() == b.id();
+    }
+
+    uint64_t key;
+    std::unique_ptr<payload_type> payload;
+};
+
+template <>
+struct record_traits<boxed_record> {
+    static constexpr bool is_record = true;
+    static uint64_t key(const boxed_record &record) { return record.key; }
+    static boxed_record make(const uint64_t key, const uint64_t id) { return boxed_record(key, id); }
+};
+
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/contenders.h"
+#include "record.h"
+
+namespace pq {
+
+/// Benchmarks on records of a key and a payload, where moving the elements
+/// costs more than for an int. The records have random keys and are pushed
+/// by rvalue reference, like a simulation hands its events to the queue.
+/// PQ::value_type must have record_traits.
+template <typename PQ>
+class record_benchmark {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+    using traits = record_traits<T>;
+
+    static std::vector<T>* random_records(const size_t size, const size_t seed) {
+        std::mt19937_64 random{seed};
+        std::vector<T> *records = new std::vector<T>;
+        records->reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            records->push_back(traits::make(random(), i));
+        }
+        return records;
+    }
+
+    static void* fill_both(PQ &queue, Configuration config, void*) {
+        std::vector<T> *records = random_records(config.first, config.second);
+        for (T &record : *records) {
+            queue.push(std::move(record));
+        }
+        delete records;
+        return random_records(config.first, config.second + 1);
+    }
+
+    // Records to sort, and the keys in the order in which they were popped
+    struct sort_state {
+        std::vector<T> *records;
+        std::vector<uint64_t> keys;
+    };
+
+    static void* fill_sort(PQ&, Configuration config, void*) {
+        sort_state *s = new sort_state;
+        s->records = random_records(config.first, config.second);
+        s->keys.reserve(config.first);
+        return s;
+    }
+
+    static void check_sorted(PQ&, Configuration config, void* data) {
+        sort_state *s = static_cast<sort_state*>(data);
+        assert(s->keys.size() == config.first);
+        assert(std::is_sorted(s->keys.rbegin(), s->keys.rend()));
+        (void)config;
+        delete s->records;
+        delete s;
+    }
+
+    static void clear_data(PQ&, Configuration, void* data) {
+        delete static_cast<std::vector<T>*>(data);
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<16, 0xBEEF),
+            std::make_pair(1<<20, 0xC0FFEE),
+            // beyond the L3 cache for all record types
+            std::make_pair(1<<22, 0xF005BA11)};
+
+        common::register_benchmark("heapsort records", "heapsort-record",
+            record_benchmark::fill_sort,
+            // Drain with top and pop, because the generic pop_n copies the
+            // records, which would allocate for boxed ones. Only the keys
+            // are kept, for the check.
+            [](PQ &queue, Configuration, void* data) {
+                sort_state *s = static_cast<sort_state*>(data);
+                for (T &record : *s->records) {
+                    queue.push(std::move(record));
+                }
+                while (queue.size() > 0) {
+                    s->keys.push_back(traits::key(queue.top()));
+                    queue.pop();
+                }
+            }, record_benchmark::check_sorted, configs, benchmarks);
+
+        common::register_benchmark("push-pop mix on records", "push-pop-mix-record",
+            record_benchmark::fill_both,
+            [](PQ &queue, Configuration, void* data) {
+                std::vector<T> &records = *static_cast<std::vector<T>*>(data);
+                for (T &record : records) {
+                    queue.push(std::move(record));
+                    queue.pop();
+                }
+            }, record_benchmark::clear_data, configs, benchmarks);
+    }
+};
+
+}
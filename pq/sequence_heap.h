@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Sanders' sequence heap ("Fast Priority Queues for Cached Memory", 2000)
+/// as a max-heap. New elements go to a small insertion heap. When it holds
+/// M elements, they are sorted into a sequence that is added to group 0. A
+/// group holds up to K sorted sequences. A full group is merged into a
+/// single sequence of the next group, so group i holds sequences of about
+/// M * K^i elements, and every element is moved about log_K(n / M) times by
+/// merges of K sequences, which are cache efficient.
+///
+/// Every group has a buffer of its largest elements, which is refilled by a
+/// K-way merge of its sequences, and a deletion buffer holds the largest
+/// elements of all groups, refilled by a merge of the group buffers. The
+/// top element is the larger of the insertion heap's and deletion buffer's.
+///
+/// Sequences and buffers are sorted in ascending order, so that elements are
+/// taken from their backs.
+template <typename T,
+          typename Compare = std::less<T>,
+          size_t K = 64,
+          size_t M = 256,
+          size_t DeletionSize = 64>
+class sequence_heap : public priority_queue<T> {
+    static_assert(K >= 2 && M >= DeletionSize && DeletionSize > 0, "Invalid sequence heap parameters");
+public:
+    sequence_heap() : num(0) {
+        insertion.reserve(M);
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("sequence heap", "sequence-heap",
+            [](){ return new sequence_heap<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        insertion.push_back(value);
+        std::push_heap(insertion.begin(), insertion.end(), comp);
+        after_push();
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        insertion.push_back(std::move(value));
+        std::push_heap(insertion.begin(), insertion.end(), comp);
+        after_push();
+    }
+
+    /// Add the elements in [first, last). Whole runs of M elements are
+    /// sorted and added as sequences without the insertion heap.
+    void push_bulk(const T *first, const T *last) override {
+        while (static_cast<size_t>(last - first) >= M) {
+            sequence run(first, first + M);
+            std::sort(run.begin(), run.end(), comp);
+            add_sequence(std::move(run));
+            num += M;
+            first += M;
+        }
+        for (; first != last; ++first) {
+            sequence_heap::push(*first);
+        }
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(num > 0);
+        if (top_in_insertion()) {
+            std::pop_heap(insertion.begin(), insertion.end(), comp);
+            insertion.pop_back();
+        } else {
+            deletion.pop_back();
+        }
+        --num;
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(num > 0);
+        return top_in_insertion() ? insertion.front() : deletion.back();
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return num;
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new sequence_heap();
+    }
+
+protected:
+    using sequence = std::vector<T>;
+
+    struct group {
+        std::vector<sequence> sequences;
+        sequence buffer; // the group's largest elements
+    };
+
+    struct head {
+        T value;
+        sequence *source;
+    };
+
+    void after_push() {
+        ++num;
+        if (insertion.size() == M) {
+            // sort_heap sorts ascending
+            std::sort_heap(insertion.begin(), insertion.end(), comp);
+            sequence run;
+            run.swap(insertion);
+            insertion.reserve(M);
+            add_sequence(std::move(run));
+        }
+    }
+
+    // Whether the top element is in the insertion heap. Refills the
+    // deletion buffer if needed.
+    bool top_in_insertion() {
+        if (deletion.empty()) refill_deletion();
+        if (deletion.empty()) return true;
+        return !insertion.empty() && comp(deletion.back(), insertion.front());
+    }
+
+    // Move the count largest elements of the sources into out in ascending
+    // order with a multiway merge. The sources are sorted ascending.
+    void merge_largest(const std::vector<sequence*> &sources, const size_t count, sequence &out) {
+        // Binary max-heap of the sources' largest elements, which are taken
+        // out of the sources while they are in the heap
+        heads.clear();
+        for (sequence *s : sources) {
+            if (s->empty()) continue;
+            heads.push_back(head{std::move(s->back()), s});
+            s->pop_back();
+        }
+        auto smaller = [this](const head &a, const head &b) { return comp(a.value, b.value); };
+        std::make_heap(heads.begin(), heads.end(), smaller);
+
+        out.resize(count);
+        for (size_t i = count; i > 0; --i) {
+            assert(!heads.empty());
+            out[i - 1] = std::move(heads[0].value);
+            sequence *s = heads[0].source;
+            if (!s->empty()) {
+                heads[0].value = std::move(s->back());
+                s->pop_back();
+            } else {
+                heads[0] = std::move(heads.back());
+                heads.pop_back();
+            }
+            sift_down_head();
+        }
+
+        // Return the remaining heads, they are their sources' largest elements
+        for (head &h : heads) {
+            h.source->push_back(std::move(h.value));
+        }
+    }
+
+    // Restore the heap property of heads after its root was replaced
+    void sift_down_head() {
+        const size_t n = heads.size();
+        if (n < 2) return;
+        head h = std::move(heads[0]);
+        size_t k = 0;
+        while (2 * k + 1 < n) {
+            size_t child = 2 * k + 1;
+            if (child + 1 < n && comp(heads[child].value, heads[child + 1].value)) ++child;
+            if (!comp(h.value, heads[child].value)) break;
+            heads[k] = std::move(heads[child]);
+            k = child;
+        }
+        heads[k] = std::move(h);
+    }
+
+    // Add a sorted sequence from the insertion heap to group 0
+    void add_sequence(sequence &&run) {
+        // Make room in group 0 by merging full groups into the next one
+        size_t free = 0;
+        while (free < groups.size() && groups[free].sequences.size() == K) ++free;
+        if (free == groups.size()) groups.emplace_back();
+        for (size_t i = free; i > 0; --i) {
+            // The next group's buffer joins the merge, so it is empty and
+            // can't hold smaller elements than the new sequence afterwards
+            std::vector<sequence*> sources{&groups[i].buffer};
+            size_t total = groups[i].buffer.size();
+            for (sequence &s : groups[i - 1].sequences) {
+                sources.push_back(&s);
+                total += s.size();
+            }
+            sequence merged;
+            merge_largest(sources, total, merged);
+            groups[i - 1].sequences.clear();
+            groups[i].sequences.push_back(std::move(merged));
+        }
+
+        // The new elements may be larger than those in the deletion buffer
+        // and group 0's buffer, so they take part in refilling both
+        group &first = groups[0];
+        if (deletion.empty() && first.buffer.empty()) {
+            first.sequences.push_back(std::move(run));
+            return;
+        }
+        sequence old_deletion, old_buffer;
+        old_deletion.swap(deletion);
+        old_buffer.swap(first.buffer);
+        std::vector<sequence*> sources{&run, &old_deletion, &old_buffer};
+        const size_t deletion_size = old_deletion.size(), buffer_size = old_buffer.size();
+        merge_largest(sources, deletion_size, deletion);
+        merge_largest(sources, buffer_size, first.buffer);
+        sequence rest;
+        merge_largest(sources, M, rest);
+        first.sequences.push_back(std::move(rest));
+    }
+
+    // Top up a group's buffer to M elements from its sequences
+    void refill_buffer(group &g) {
+        std::vector<sequence*> sources;
+        size_t total = 0;
+        for (sequence &s : g.sequences) {
+            sources.push_back(&s);
+            total += s.size();
+        }
+        // The new elements are smaller than the remaining ones
+        sequence refill;
+        merge_largest(sources, std::min(M - g.buffer.size(), total), refill);
+        refill.insert(refill.end(), std::make_move_iterator(g.buffer.begin()),
+                      std::make_move_iterator(g.buffer.end()));
+        g.buffer.swap(refill);
+        g.sequences.erase(std::remove_if(g.sequences.begin(), g.sequences.end(),
+            [](const sequence &s) { return s.empty(); }), g.sequences.end());
+    }
+
+    void refill_deletion() {
+        assert(deletion.empty());
+        std::vector<sequence*> sources;
+        size_t count = DeletionSize, total = 0;
+        for (group &g : groups) {
+            if (g.buffer.size() < DeletionSize && !g.sequences.empty()) {
+                refill_buffer(g);
+            }
+            // A buffer of a group with sequences left must not run empty
+            if (!g.sequences.empty()) {
+                count = std::min(count, g.buffer.size());
+            }
+            sources.push_back(&g.buffer);
+            total += g.buffer.size();
+        }
+        merge_largest(sources, std::min(count, total), deletion);
+    }
+
+    Compare comp;
+    sequence insertion; // binary heap
+    sequence deletion;
+    std::vector<group> groups;
+    std::vector<head> heads; // used by merge_largest
+    size_t num;
+};
+
+}
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/aligned_allocator.h"
+#include "../common/contenders.h"
+#include "../common/epoch.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Lock-free skiplist priority queue (Lindén, Jonsson 2013) as a max-heap.
+/// The skiplist is sorted by decreasing priority. try_pop walks the lowest
+/// level from the head and deletes the first element that is not deleted
+/// yet by setting the mark bit in its predecessor's next pointer with an
+/// atomic fetch-or, so deleted elements always form a prefix of the list and
+/// concurrent pops only touch that prefix. Once the prefix is longer than
+/// BoundOffset, one pop unlinks it from the head with a single CAS and frees
+/// it through epoch-based reclamation, which batches the physical deletion
+/// of many elements. push is the usual lock-free skiplist insert, which
+/// can't insert into the deleted prefix because its CAS fails on marked
+/// pointers. Unlike the MultiQueue, try_pop is linearizable and always
+/// removes the top element.
+template <typename T,
+          size_t BoundOffset = 32,
+          typename Compare = std::less<T>>
+class skiplist_pq : public priority_queue<T> {
+public:
+    static constexpr int max_level = 32;
+
+    skiplist_pq()
+        : head(allocate(max_level)), tail(allocate(1)), counters(num_counters())
+    {
+        for (int i = 0; i < max_level; ++i) {
+            head->next[i].store(ref(tail), std::memory_order_relaxed);
+        }
+    }
+    skiplist_pq(const skiplist_pq&) = delete;
+
+    virtual ~skiplist_pq() {
+        // No other thread may access the queue any more. Retired nodes are
+        // freed by the epoch manager.
+        node *n = unmarked(head->next[0].load());
+        while (n != tail) {
+            node *next = unmarked(n->next[0].load());
+            destroy(n);
+            n = next;
+        }
+        ::operator delete(head);
+        ::operator delete(tail);
+    }
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("lock-free skiplist, bound 32", "skiplist-32",
+            [](){ return new skiplist_pq<T, 32>(); }
+        ));
+        list.register_contender(Factory("lock-free skiplist, bound 128", "skiplist-128",
+            [](){ return new skiplist_pq<T, 128>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        insert(create(random_level(), value));
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        insert(create(random_level(), std::move(value)));
+    }
+
+    /// Remove the top element and write it to out
+    bool try_pop(T &out) override {
+        common::epoch_manager::guard guard(epochs);
+        node *n = delete_min();
+        if (n == nullptr) return false;
+        // Deleted nodes don't change and are freed after the guard only
+        out = n->value();
+        return true;
+    }
+
+    bool concurrent() const override {
+        return true;
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        common::epoch_manager::guard guard(epochs);
+        node *n = delete_min();
+        assert(n != nullptr);
+        (void)n;
+    }
+
+    /// Retrieves the top element, the first one that is not deleted
+    const T& top() override {
+        node *x = head;
+        while (true) {
+            const uintptr_t next = x->next[0].load();
+            assert(unmarked(next) != tail);
+            if (!is_marked(next)) return unmarked(next)->value();
+            x = unmarked(next);
+        }
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        int64_t num = 0;
+        for (const auto &c : counters) {
+            num += c.value.load(std::memory_order_relaxed);
+        }
+        return static_cast<size_t>(num);
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new skiplist_pq();
+    }
+
+protected:
+    struct node {
+        explicit node(const int level) : level(level), inserting(false), next{{0}} {
+            for (int i = 1; i < level; ++i) {
+                new (&next[i]) std::atomic<uintptr_t>(0);
+            }
+        }
+
+        T& value() {
+            return *reinterpret_cast<T*>(&storage);
+        }
+
+        int level;
+        std::atomic<bool> inserting;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        // One pointer per level, allocated past the end of the node. Bit 0 of
+        // the lowest one marks the next node as deleted.
+        std::atomic<uintptr_t> next[1];
+    };
+
+    // Retired prefix of the list, freed once no thread can access it
+    struct garbage {
+        node *first, *stop;
+        ~garbage() {
+            while (first != stop) {
+                node *next = unmarked(first->next[0].load(std::memory_order_relaxed));
+                destroy(first);
+                first = next;
+            }
+        }
+    };
+
+    // Element counts of groups of threads, so that size() doesn't need a
+    // counter that every operation writes to
+    struct alignas(64) counter {
+        std::atomic<int64_t> value{0};
+    };
+
+    static uintptr_t ref(node *n) { return reinterpret_cast<uintptr_t>(n); }
+    static uintptr_t marked(node *n) { return ref(n) | 1; }
+    static bool is_marked(const uintptr_t r) { return (r & 1) != 0; }
+    static node* unmarked(const uintptr_t r) { return reinterpret_cast<node*>(r & ~uintptr_t(1)); }
+
+    // Allocate a node with space for level next pointers, without a value
+    static node* allocate(const int level) {
+        void *memory = ::operator new(sizeof(node) + (level - 1) * sizeof(std::atomic<uintptr_t>));
+        return new (memory) node(level);
+    }
+
+    template <typename V>
+    static node* create(const int level, V &&value) {
+        node *n = allocate(level);
+        new (&n->storage) T(std::forward<V>(value));
+        n->inserting.store(true, std::memory_order_relaxed);
+        return n;
+    }
+
+    static void destroy(node *n) {
+        n->value().~T();
+        ::operator delete(n);
+    }
+
+    void insert(node *n) {
+        common::epoch_manager::guard guard(epochs);
+        node *preds[max_level], *succs[max_level];
+        node *del;
+        do {
+            del = locate_preds(n->value(), preds, succs);
+            n->next[0].store(ref(succs[0]), std::memory_order_relaxed);
+        } while (!cas(preds[0]->next[0], ref(succs[0]), ref(n)));
+
+        for (int i = 1; i < n->level; ) {
+            n->next[i].store(ref(succs[i]), std::memory_order_relaxed);
+            // Stop if n or its successor got deleted in the meantime
+            if (is_marked(n->next[0].load()) || is_marked(succs[i]->next[0].load()) ||
+                    del == succs[i]) {
+                break;
+            }
+            if (cas(preds[i]->next[i], ref(succs[i]), ref(n))) {
+                ++i;
+            } else {
+                del = locate_preds(n->value(), preds, succs);
+                if (succs[0] != n) break;
+            }
+        }
+        n->inserting.store(false);
+        count(1);
+    }
+
+    // Find the predecessors and successors of value on every level, skipping
+    // deleted nodes. Returns the last deleted node on the lowest level.
+    node* locate_preds(const T &value, node **preds, node **succs) {
+        node *pred = head, *del = nullptr;
+        for (int i = max_level - 1; i >= 0; --i) {
+            uintptr_t cur_ref = pred->next[i].load();
+            bool d = is_marked(cur_ref);
+            node *cur = unmarked(cur_ref);
+            while (cur != tail && (comp(value, cur->value()) ||
+                    is_marked(cur->next[0].load()) || (i == 0 && d))) {
+                if (i == 0 && d) del = cur;
+                pred = cur;
+                cur_ref = pred->next[i].load();
+                d = is_marked(cur_ref);
+                cur = unmarked(cur_ref);
+            }
+            preds[i] = pred;
+            succs[i] = cur;
+        }
+        return del;
+    }
+
+    // Logically delete the first node that is not deleted yet and unlink the
+    // deleted prefix if it is long enough. Returns nullptr if the queue is
+    // empty. Must be called in a critical section.
+    node* delete_min() {
+        node *x = head, *new_head = nullptr;
+        const uintptr_t observed_head = head->next[0].load();
+        size_t offset = 0;
+        uintptr_t next;
+        do {
+            next = x->next[0].load();
+            if (unmarked(next) == tail) return nullptr;
+            // Nodes that are still being inserted may be linked to on higher
+            // levels, so the prefix may only be unlinked up to them
+            if (new_head == nullptr && x->inserting.load()) new_head = x;
+            next = x->next[0].fetch_or(1);
+            ++offset;
+            x = unmarked(next);
+        } while (is_marked(next));
+        count(-1);
+
+        if (new_head == nullptr) new_head = x;
+        uintptr_t expected = observed_head;
+        if (offset >= BoundOffset && cas(head->next[0], expected, marked(new_head))) {
+            restructure();
+            epochs.retire(new garbage{unmarked(observed_head), new_head});
+            epochs.reclaim();
+        }
+        return x;
+    }
+
+    // Move the head's pointers on higher levels past deleted nodes
+    void restructure() {
+        node *pred = head;
+        for (int i = max_level - 1; i > 0; ) {
+            const uintptr_t h = head->next[i].load();
+            if (!is_marked(unmarked(h)->next[0].load())) {
+                --i;
+                continue;
+            }
+            node *cur = unmarked(pred->next[i].load());
+            while (is_marked(cur->next[0].load())) {
+                pred = cur;
+                cur = unmarked(pred->next[i].load());
+            }
+            if (cas(head->next[i], h, ref(cur))) --i;
+        }
+    }
+
+    static bool cas(std::atomic<uintptr_t> &target, uintptr_t expected, const uintptr_t desired) {
+        return target.compare_exchange_strong(expected, desired);
+    }
+
+    void count(const int64_t delta) {
+        const size_t index = common::epoch_manager::thread_index() & (counters.size() - 1);
+        counters[index].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // A power of two that is at least the number of cores
+    static size_t num_counters() {
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        size_t num = 1;
+        while (num < cores) num *= 2;
+        return num;
+    }
+
+    // Geometric distribution with p = 1/2, from a per-thread xorshift
+    static int random_level() {
+        static std::atomic<uint64_t> threads{0};
+        thread_local uint64_t state =
+            (threads.fetch_add(1, std::memory_order_relaxed) + 1) * 0x9E3779B97F4A7C15ull;
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        return __builtin_ctzll(state | (uint64_t(1) << (max_level - 1))) + 1;
+    }
+
+    Compare comp;
+    node *head, *tail;
+    std::vector<counter, common::aligned_allocator<counter>> counters;
+    mutable common::epoch_manager epochs;
+};
+
+template <typename T, size_t BoundOffset, typename Compare>
+constexpr int skiplist_pq<T, BoundOffset, Compare>::max_level;
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../common/aligned_allocator.h"
+#include "../common/contenders.h"
+#include "priority_queue.h"
+#include "record.h"
+
+namespace pq {
+
+/// D-ary max-heap of records that keeps the records in an array of slots
+/// that never move and sifts only their keys and slot numbers (structure of
+/// arrays). An entry takes 16 bytes however large the records are, so four
+/// children fill a cache line like in dary_heap, and records with payloads
+/// on the heap are moved once on push and once on pop. Entries with equal
+/// keys compare the records, so the order is the same as the records'.
+/// T must have record_traits.
+template <typename T,
+          size_t D = 4>
+class soa_heap : public priority_queue<T> {
+    static_assert(D >= 2, "A heap node needs at least two children");
+    using traits = record_traits<T>;
+public:
+    soa_heap() : heap(D - 1) {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("SoA binary heap", "soa-2-ary-heap",
+            [](){ return new soa_heap<T, 2>(); }
+        ));
+        list.register_contender(Factory("SoA 4-ary heap", "soa-4-ary-heap",
+            [](){ return new soa_heap<T, 4>(); }
+        ));
+        list.register_contender(Factory("SoA 8-ary heap", "soa-8-ary-heap",
+            [](){ return new soa_heap<T, 8>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        push(T(value));
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        uint32_t slot;
+        if (free_slots.empty()) {
+            slot = static_cast<uint32_t>(slots.size());
+            slots.push_back(std::move(value));
+        } else {
+            slot = free_slots.back();
+            free_slots.pop_back();
+            slots[slot] = std::move(value);
+        }
+        heap.push_back(entry{traits::key(slots[slot]), slot});
+        sift_up(size() - 1);
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        // Release the payload now, like the other queues do
+        slots[at(0).slot] = T();
+        remove_top();
+    }
+
+    /// Remove the n top elements and move them to out in descending order
+    void pop_n(size_t n, T *out) override {
+        assert(n <= size());
+        for (; n > 0; --n) {
+            *out++ = std::move(slots[at(0).slot]);
+            remove_top();
+        }
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        return slots[at(0).slot];
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return heap.size() - (D - 1);
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new soa_heap();
+    }
+
+protected:
+    struct entry {
+        uint64_t key;
+        uint32_t slot;
+    };
+
+    // Free the slot of the top entry and fill its place in the heap
+    void remove_top() {
+        free_slots.push_back(at(0).slot);
+        const entry last = heap.back();
+        heap.pop_back();
+        if (size() > 0) {
+            sift_down(0, last);
+        }
+    }
+
+    // Whether a comes out after b
+    bool before(const entry &a, const entry &b) const {
+        return a.key < b.key || (a.key == b.key && slots[a.slot] < slots[b.slot]);
+    }
+
+    // Entry k of the heap is stored at heap[k + D - 1], so that the children
+    // of every node start at a multiple of D
+    entry& at(const size_t k) { return heap[k + D - 1]; }
+
+    // Move the entry at k up until its parent is not ordered before it
+    void sift_up(size_t k) {
+        const entry value = at(k);
+        while (k > 0) {
+            const size_t parent = (k - 1) / D;
+            if (!before(at(parent), value)) break;
+            at(k) = at(parent);
+            k = parent;
+        }
+        at(k) = value;
+    }
+
+    // Move the hole at k down along the largest children until value fits
+    // into it
+    void sift_down(size_t k, const entry value) {
+        const size_t n = size();
+        while (true) {
+            const size_t first = D * k + 1;
+            if (first >= n) break;
+            size_t best = first;
+            for (size_t i = first + 1; i < std::min(first + D, n); ++i) {
+                if (before(at(best), at(i))) best = i;
+            }
+            if (!before(value, at(best))) break;
+            at(k) = at(best);
+            k = best;
+        }
+        at(k) = value;
+    }
+
+    std::vector<entry, common::aligned_allocator<entry>> heap;
+    std::vector<T> slots;
+    std::vector<uint32_t> free_slots;
+};
+
+}
@@ -39,6 +39,16 @@ public:
         queue.emplace(std::forward<Args>(args)...);
     }
 
+    /// Add the elements in [first, last). An empty queue is built from them
+    /// with std::make_heap.
+    void push_bulk(const T *first, const T *last) override {
+        if (queue.empty()) {
+            queue = std::priority_queue<T, Container, Compare>(Compare(), Container(first, last));
+        } else {
+            priority_queue<T>::push_bulk(first, last);
+        }
+    }
+
     /// Deletes the top element
     void pop() override {
         queue.pop();
@@ -54,6 +64,10 @@ public:
         return queue.size();
     }
 
+    priority_queue<T>* create_empty() const override {
+        return new std_pq();
+    }
+
 protected:
     std::priority_queue<T, Container, Compare> queue;
 };
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace pq {
+
+/// String element that counts how often it is compared, for benchmarks
+/// where comparisons are more expensive than moving elements around, such as
+/// rules that are ordered by name. The count is a plain global, so it is
+/// only exact if a single thread compares keys.
+class string_key {
+public:
+    string_key() {}
+    explicit string_key(std::string name) : name(std::move(name)) {}
+
+    const std::string& str() const {
+        return name;
+    }
+
+    /// Number of comparisons with operator< since the last reset
+    static size_t comparisons() {
+        return counter();
+    }
+    static void reset_comparisons() {
+        counter() = 0;
+    }
+
+    friend bool operator<(const string_key &a, const string_key &b) {
+        ++counter();
+        return a.name < b.name;
+    }
+    friend bool operator==(const string_key &a, const string_key &b) {
+        return a.name == b.name;
+    }
+
+protected:
+    static size_t& counter() {
+        static size_t count = 0;
+        return count;
+    }
+
+    std::string name;
+};
+
+}
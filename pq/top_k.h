@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../common/benchmark.h"
+#include "../common/benchmark_util.h"
+#include "../common/contenders.h"
+#include "bounded_priority_queue.h"
+
+namespace pq {
+
+/// Select the k smallest elements of a stream of random elements, the way
+/// analytics compute top-k lists continuously. The queue holds the k
+/// smallest elements so far, so its top is the k-th smallest one, and
+/// most elements of the stream are larger and dropped after a comparison
+/// with it. Bounded queues get the bound and every element of the stream;
+/// for the others, the benchmark compares with top() and replaces the top
+/// with a pop and a push.
+template <typename PQ>
+class top_k {
+public:
+    using Configuration = std::pair<size_t, size_t>;
+    using Benchmark = common::benchmark<PQ, Configuration>;
+    using BenchmarkFactory = common::contender_factory<Benchmark>;
+    using T = typename PQ::value_type;
+    using Bounded = bounded_priority_queue<T>;
+
+    static void* fill(PQ &queue, Configuration config, const size_t k) {
+        Bounded *bounded = dynamic_cast<Bounded*>(&queue);
+        if (bounded != nullptr) {
+            bounded->bound(k);
+        }
+        return common::util::fill_data_random<T>(config.first, config.second);
+    }
+
+    static void run(PQ &queue, Configuration config, void* ptr, const size_t k) {
+        const T* data = static_cast<const T*>(ptr);
+        const size_t n = config.first;
+        Bounded *bounded = dynamic_cast<Bounded*>(&queue);
+        if (bounded != nullptr) {
+            for (size_t i = 0; i < n; ++i) {
+                bounded->push(data[i]);
+            }
+            return;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (queue.size() < k) {
+                queue.push(data[i]);
+            } else if (data[i] < queue.top()) {
+                queue.pop();
+                queue.push(data[i]);
+            }
+        }
+    }
+
+    // Check that the queue pops the k smallest elements of the stream
+    static void check_smallest(PQ &queue, Configuration config, void* ptr, const size_t k) {
+        T* data = static_cast<T*>(ptr);
+        std::nth_element(data, data + k, data + config.first);
+        std::sort(data, data + k);
+        assert(queue.size() == k);
+        for (size_t i = k; i > 0; --i) {
+            assert(queue.top() == data[i - 1]);
+            queue.pop();
+        }
+        common::util::delete_data<T>(data);
+    }
+
+    static void register_benchmarks(common::contender_list<Benchmark> &benchmarks) {
+        const std::vector<Configuration> configs{
+            std::make_pair(1<<26, 0xF005BA11)};
+
+        for (const size_t k : {10, 1<<8, 1<<12, 1<<16}) {
+            common::register_benchmark(
+                "top " + std::to_string(k) + " of a stream",
+                "top-k-" + std::to_string(k),
+                [k](PQ &queue, Configuration config, void*) {
+                    return top_k::fill(queue, config, k);
+                },
+                [k](PQ &queue, Configuration config, void* data) {
+                    top_k::run(queue, config, data, k);
+                },
+                [k](PQ &queue, Configuration config, void* data) {
+                    top_k::check_smallest(queue, config, data, k);
+                }, configs, benchmarks);
+        }
+    }
+};
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "bounded_priority_queue.h"
+
+namespace pq {
+
+/// Binary heap with an optional fixed capacity, for selecting the k
+/// elements of a stream that come out last. Once the heap is full, push
+/// compares the new element with the top only and drops it if it isn't
+/// ordered before the top, without touching the rest of the heap. Otherwise
+/// it replaces the top with a single sift-down instead of a pop and a push.
+/// On a random stream of n elements, only O(k log(n/k)) of them get past
+/// the comparison with the top. Without a bound, it is a plain binary heap.
+template <typename T,
+          typename Compare = std::less<T>>
+class top_k_queue : public bounded_priority_queue<T> {
+public:
+    top_k_queue() : capacity(std::numeric_limits<size_t>::max()) {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("bounded binary heap", "top-k-queue",
+            [](){ return new top_k_queue<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        if (data.size() < capacity) {
+            data.push_back(value);
+            sift_up(data.size() - 1);
+        } else if (capacity > 0 && comp(value, data[0])) {
+            sift_down(0, T(value));
+        }
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        if (data.size() < capacity) {
+            data.push_back(std::move(value));
+            sift_up(data.size() - 1);
+        } else if (capacity > 0 && comp(value, data[0])) {
+            sift_down(0, std::move(value));
+        }
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        T value = std::move(data.back());
+        data.pop_back();
+        if (size() > 0) {
+            sift_down(0, std::move(value));
+        }
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        return data[0];
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return data.size();
+    }
+
+    /// Keep at most k elements, the array is allocated once for all of them
+    void bound(const size_t k) override {
+        capacity = k;
+        while (size() > capacity) {
+            pop();
+        }
+        data.reserve(capacity);
+    }
+
+    priority_queue<T>* create_empty() const override {
+        top_k_queue *queue = new top_k_queue();
+        queue->capacity = capacity;
+        return queue;
+    }
+
+protected:
+    // Move the element at k up until its parent is not ordered before it
+    void sift_up(size_t k) {
+        T value = std::move(data[k]);
+        while (k > 0) {
+            const size_t parent = (k - 1) / 2;
+            if (!comp(data[parent], value)) break;
+            data[k] = std::move(data[parent]);
+            k = parent;
+        }
+        data[k] = std::move(value);
+    }
+
+    // Move the hole at k down along the larger children until value fits
+    // into it
+    void sift_down(size_t k, T &&value) {
+        const size_t n = size();
+        while (2 * k + 1 < n) {
+            size_t child = 2 * k + 1;
+            if (child + 1 < n && comp(data[child], data[child + 1])) ++child;
+            if (!comp(value, data[child])) break;
+            data[k] = std::move(data[child]);
+            k = child;
+        }
+        data[k] = std::move(value);
+    }
+
+    Compare comp;
+    size_t capacity;
+    std::vector<T> data;
+};
+
+}
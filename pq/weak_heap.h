@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../common/contenders.h"
+#include "priority_queue.h"
+
+namespace pq {
+
+/// Weak heap (Dutton 1993) as a max-heap. Every element is at least as large
+/// as the elements in its right subtree, the left subtree is unordered. The
+/// root has no left subtree, so it is the largest element. Element i has the
+/// children 2i + r[i] (left) and 2i + 1 - r[i] (right), so flipping the bit
+/// r[i] swaps the subtrees in constant time.
+///
+/// Two elements are joined by comparing them and flipping a bit if they have
+/// to be swapped. pop makes at most log n comparisons, against about 2 log n
+/// for a binary heap, and push averages a constant number. This pays off if
+/// comparisons are more expensive than memory accesses, for example with
+/// string keys.
+template <typename T,
+          typename Compare = std::less<T>>
+class weak_heap : public priority_queue<T> {
+public:
+    weak_heap() {}
+
+    static void register_contenders(common::contender_list<priority_queue<T>> &list) {
+        using Factory = common::contender_factory<priority_queue<T>>;
+        list.register_contender(Factory("weak heap", "weak-heap",
+            [](){ return new weak_heap<T>(); }
+        ));
+    }
+
+    /// Add an element to the priority queue by const lvalue reference
+    void push(const T& value) override {
+        data.push_back(value);
+        inserted();
+    }
+    /// Add an element to the priority queue by rvalue reference (with move)
+    void push(T&& value) override {
+        data.push_back(std::move(value));
+        inserted();
+    }
+
+    /// Deletes the top element
+    void pop() override {
+        assert(size() > 0);
+        data.front() = std::move(data.back());
+        data.pop_back();
+        reverse.pop_back();
+        if (size() > 1) sift_down();
+    }
+
+    /// Retrieves the top element
+    const T& top() override {
+        assert(size() > 0);
+        return data.front();
+    }
+
+    /// Add the elements in [first, last). If that at least doubles the size,
+    /// the heap is rebuilt with n - 1 joins, from the last element to the
+    /// first.
+    void push_bulk(const T *first, const T *last) override {
+        const size_t old_size = size();
+        if (static_cast<size_t>(last - first) < old_size) {
+            priority_queue<T>::push_bulk(first, last);
+            return;
+        }
+        data.insert(data.end(), first, last);
+        reverse.assign(size(), 0);
+        for (size_t j = size(); j > 1; --j) {
+            join(ancestor(j - 1), j - 1);
+        }
+    }
+
+    /// Get the number of elements in the priority queue
+    size_t size() override {
+        return data.size();
+    }
+
+    priority_queue<T>* create_empty() const override {
+        return new weak_heap();
+    }
+
+protected:
+    // Restore the order after an element was appended, by joining it with
+    // its distinguished ancestors until one of them is larger
+    void inserted() {
+        const size_t j = size() - 1;
+        reverse.push_back(0);
+        // j becomes the left child of its parent if it is the first child
+        if (j > 0 && (j & 1) == 0) reverse[j / 2] = 0;
+        sift_up(j);
+    }
+
+    // The distinguished ancestor of j, the parent of the first ancestor of j
+    // (or j itself) that is a right child. j is in its right subtree.
+    size_t ancestor(size_t j) const {
+        while ((j & 1) == reverse[j / 2]) j /= 2;
+        return j / 2;
+    }
+
+    // Swap the elements at i and j if j is larger than its distinguished
+    // ancestor i, and flip j's subtrees so that the order holds again.
+    // Returns whether they were swapped.
+    bool join(const size_t i, const size_t j) {
+        if (!comp(data[i], data[j])) return false;
+        std::swap(data[i], data[j]);
+        reverse[j] ^= 1;
+        return true;
+    }
+
+    void sift_up(size_t j) {
+        while (j != 0) {
+            const size_t i = ancestor(j);
+            if (!join(i, j)) break;
+            j = i;
+        }
+    }
+
+    // Walk down the left spine of the root's right subtree and join every
+    // node on it with the root on the way back up
+    void sift_down() {
+        const size_t n = size();
+        size_t j = 1;
+        for (size_t k; (k = 2 * j + reverse[j]) < n; ) {
+            j = k;
+        }
+        for (; j != 0; j /= 2) {
+            join(0, j);
+        }
+    }
+
+    Compare comp;
+    std::vector<T> data;
+    std::vector<uint8_t> reverse; // the bits that swap the subtrees
+};
+
+}
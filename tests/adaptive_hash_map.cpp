@@ -0,0 +1,95 @@
+#include "catch.hpp"
+#include "random_util.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <hashtable/adaptive_hash_map.h>
+#include <hashtable/pod16.h>
+
+template <typename Map, typename Key>
+static void check_against_reference(Map &m, const size_t key_range) {
+	std::unordered_map<Key, int> reference;
+	uint64_t state = 42;
+	for (int i = 0; i < 20000; ++i) {
+		next_random(state);
+		const Key key = static_cast<Key>(1 + state % key_range);
+		if (state % 3 == 0) {
+			CHECK(m.erase(key) == reference.erase(key));
+		} else {
+			m[key] += i;
+			reference[key] += i;
+		}
+		REQUIRE(m.size() == reference.size());
+	}
+	for (auto &entry : reference) {
+		CHECK(m.find(entry.first) == just<int>(entry.second));
+	}
+	size_t visited = 0;
+	m.for_each([&](const Key &key, int &value) {
+		++visited;
+		CHECK(reference[key] == value);
+	});
+	CHECK(visited == reference.size());
+}
+
+SCENARIO("adaptive_hash_map behaves like std::unordered_map", "[hashtable]") {
+	GIVEN("Tables that stay in the small array") {
+		hashtable::adaptive_hash_map<int, int> a;
+		hashtable::adaptive_hash_map<hashtable::pod16, int> b;
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a, 16);
+			check_against_reference<decltype(b), hashtable::pod16>(b, 16);
+		}
+	}
+	GIVEN("Tables that grow into open addressing") {
+		hashtable::adaptive_hash_map<int, int> a;
+		hashtable::adaptive_hash_map<uint64_t, int> b;
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a, 2000);
+			check_against_reference<decltype(b), uint64_t>(b, 2000);
+		}
+	}
+	GIVEN("A table that is split into shards") {
+		hashtable::adaptive_hash_map<int, int> a(64);
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a, 2000);
+		}
+		WHEN("We clear it") {
+			check_against_reference<decltype(a), int>(a, 2000);
+			a.clear();
+			THEN("It starts over with the small array") {
+				CHECK(a.size() == 0);
+				check_against_reference<decltype(a), int>(a, 10);
+			}
+		}
+	}
+}
+
+SCENARIO("adaptive_hash_map with string keys", "[hashtable]") {
+	GIVEN("An adaptive_hash_map with string keys") {
+		hashtable::adaptive_hash_map<std::string, std::string> m(32);
+		for (int i = 0; i < 10; ++i) {
+			m[std::to_string(i)] = std::string(i, 'x');
+		}
+		THEN("The small array holds them") {
+			CHECK(m.size() == 10);
+			CHECK(m.find("9") == just<std::string>(std::string(9, 'x')));
+		}
+		WHEN("We erase some keys and add more") {
+			for (int i = 0; i < 10; i += 2) {
+				m.erase(std::to_string(i));
+			}
+			for (int i = 10; i < 100; ++i) {
+				m[std::to_string(i)] = std::string(i, 'x');
+			}
+			THEN("The others are still there") {
+				CHECK(m.size() == 95);
+				CHECK(m.find("0") == nothing<std::string>());
+				CHECK(m.find("1") == just<std::string>(std::string(1, 'x')));
+				CHECK(m.find("99") == just<std::string>(std::string(99, 'x')));
+			}
+		}
+	}
+}
@@ -0,0 +1,178 @@
+#include "catch.hpp"
+#include "random_util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <hashtable/btree_map.h>
+#include <hashtable/pod16.h>
+
+template <typename Map, typename Key>
+static void check_against_reference(Map &m, const size_t key_range) {
+	std::map<Key, int> reference;
+	uint64_t state = 42;
+	for (int i = 0; i < 50000; ++i) {
+		next_random(state);
+		const Key key = static_cast<Key>(1 + state % key_range);
+		// erase more often in the second half to shrink the tree again
+		if (state % 5 < (i < 25000 ? 1u : 3u)) {
+			CHECK(m.erase(key) == reference.erase(key));
+		} else {
+			m[key] += i;
+			reference[key] += i;
+		}
+	}
+	REQUIRE(m.size() == reference.size());
+	for (auto &entry : reference) {
+		CHECK(m.find(entry.first) == just<int>(entry.second));
+	}
+
+	// for_each and for_range visit keys in order
+	std::vector<Key> keys;
+	m.for_each([&](const Key &key, int &value) {
+		keys.push_back(key);
+		CHECK(reference[key] == value);
+	});
+	REQUIRE(keys.size() == reference.size());
+	CHECK(std::equal(keys.begin(), keys.end(), reference.begin(),
+		[](const Key &a, const std::pair<const Key, int> &b) { return !(a < b.first) && !(b.first < a); }));
+
+	const Key lo = static_cast<Key>(key_range / 4), hi = static_cast<Key>(key_range / 2);
+	keys.clear();
+	m.for_range(lo, hi, [&](const Key &key, int &) { keys.push_back(key); });
+	auto first = reference.lower_bound(lo), last = reference.lower_bound(hi);
+	REQUIRE(keys.size() == static_cast<size_t>(std::distance(first, last)));
+	CHECK(std::equal(keys.begin(), keys.end(), first,
+		[](const Key &a, const std::pair<const Key, int> &b) { return !(a < b.first) && !(b.first < a); }));
+}
+
+SCENARIO("btree_map behaves like std::map", "[hashtable]") {
+	GIVEN("B+ trees with SIMD or generic node search") {
+		hashtable::btree_map<int, int> a;
+		hashtable::btree_map<uint64_t, int> b;
+		hashtable::btree_map<hashtable::pod16, int> c;
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a, 20000);
+			check_against_reference<decltype(b), uint64_t>(b, 20000);
+			check_against_reference<decltype(c), hashtable::pod16>(c, 20000);
+		}
+	}
+	GIVEN("B+ trees with the smallest nodes") {
+		// four keys per node, so splits, merges and rotations happen often
+		hashtable::btree_map<int, int, std::less<int>, 1> a, a2;
+		hashtable::btree_map<int, int, std::greater<int>, 1> b;
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a, 2000);
+			check_against_reference<decltype(a2), int>(a2, 200000);
+			// ranges follow the comparator
+			for (int i = 0; i < 1000; ++i) {
+				b[i * 7 % 1000] = i;
+			}
+			std::vector<int> keys;
+			b.for_range(900, 100, [&](const int &key, int &) { keys.push_back(key); });
+			REQUIRE(keys.size() == 800);
+			CHECK(keys.front() == 900);
+			CHECK(keys.back() == 101);
+		}
+	}
+	GIVEN("Two B+ trees with the smallest nodes and overlapping keys") {
+		hashtable::btree_map<int, int, std::less<int>, 1> a, b;
+		std::map<int, int> reference;
+		uint64_t state = 42;
+		for (int i = 0; i < 20000; ++i) {
+			next_random(state);
+			const int key = static_cast<int>(state % 50000);
+			if (i % 3 == 0) {
+				a[key] += 1;
+				reference[key] += 1;
+			} else {
+				b[key] += 2;
+				reference[key] += 2;
+			}
+		}
+		WHEN("We merge one into the other") {
+			a.merge_from(std::move(b), [](int &ours, int &&theirs) { ours += theirs; });
+			THEN("It holds the union in order, with combined values") {
+				REQUIRE(a.size() == reference.size());
+				CHECK(b.size() == 0);
+				std::vector<std::pair<int, int>> elements;
+				a.for_each([&](const int &key, int &value) { elements.emplace_back(key, value); });
+				const std::vector<std::pair<int, int>> expected(reference.begin(), reference.end());
+				CHECK(elements == expected);
+				for (auto &entry : reference) {
+					REQUIRE(a.find(entry.first) == just<int>(entry.second));
+				}
+			}
+			AND_THEN("Erasing every key keeps the tree consistent") {
+				for (size_t round = 0; round < 2; ++round) {
+					size_t i = 0;
+					for (auto &entry : reference) {
+						if (i++ % 2 != round) continue;
+						REQUIRE(a.erase(entry.first) == 1);
+					}
+					i = 0;
+					for (auto &entry : reference) {
+						if (i++ % 2 > round) {
+							REQUIRE(a.find(entry.first) == just<int>(entry.second));
+						}
+					}
+				}
+				CHECK(a.size() == 0);
+			}
+		}
+	}
+	GIVEN("A B+ tree filled in ascending order") {
+		hashtable::btree_map<int, int> m;
+		for (int i = 0; i < 100000; ++i) {
+			m[i] = i;
+		}
+		WHEN("We erase all keys in ascending order") {
+			for (int i = 0; i < 100000; ++i) {
+				REQUIRE(m.erase(i) == 1);
+				if (i % 1000 == 0) {
+					REQUIRE(m.find(i + 1) == just<int>(i + 1));
+				}
+			}
+			THEN("It is empty") {
+				CHECK(m.size() == 0);
+				CHECK(m.find(0) == nothing<int>());
+			}
+		}
+	}
+}
+
+SCENARIO("btree_map with string keys", "[hashtable]") {
+	GIVEN("A btree_map with string keys") {
+		hashtable::btree_map<std::string, std::string> m;
+		for (int i = 0; i < 100; ++i) {
+			m[std::to_string(i)] = std::string(i, 'x');
+		}
+		WHEN("We erase some keys") {
+			for (int i = 0; i < 100; i += 2) {
+				m.erase(std::to_string(i));
+			}
+			THEN("The others are still there") {
+				CHECK(m.size() == 50);
+				CHECK(m.find("0") == nothing<std::string>());
+				CHECK(m.find("99") == just<std::string>(std::string(99, 'x')));
+			}
+		}
+		WHEN("We merge another table into it") {
+			hashtable::btree_map<std::string, std::string> other;
+			other["1"] = "y";
+			other["foo"] = "bar";
+			m.merge_from(std::move(other), [](std::string &ours, std::string &&theirs) {
+				ours += theirs;
+			});
+			THEN("Values are combined and new keys inserted") {
+				CHECK(m.size() == 101);
+				CHECK(m.find("1") == just<std::string>("xy"));
+				CHECK(m.find("foo") == just<std::string>("bar"));
+				CHECK(other.size() == 0);
+			}
+		}
+	}
+}
@@ -0,0 +1,142 @@
+#include "catch.hpp"
+#include "random_util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include <pq/multiqueue.h>
+#include <pq/skiplist_pq.h>
+
+template <typename PQ>
+static void check_drain(PQ &queue, std::priority_queue<int> &reference) {
+	REQUIRE(queue.size() == reference.size());
+	while (!reference.empty()) {
+		REQUIRE(queue.top() == reference.top());
+		queue.pop();
+		reference.pop();
+	}
+	int value;
+	CHECK_FALSE(queue.try_pop(value));
+	CHECK(queue.size() == 0);
+}
+
+/// Push distinct elements from several threads that also pop after every
+/// second push, then check that every element was popped exactly once.
+/// Returns the elements left after the threads finished, in drain order.
+template <typename PQ>
+static std::vector<int> check_concurrent_push_pop(PQ &queue) {
+	const int num_threads = 4, per_thread = 20000;
+	std::vector<std::vector<int>> popped(num_threads);
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < num_threads; ++t) {
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < per_thread; ++i) {
+				queue.push(t * per_thread + i);
+				// pop after every second push
+				int value;
+				if (i % 2 == 1 && queue.try_pop(value)) {
+					popped[t].push_back(value);
+				}
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	std::vector<int> rest, all;
+	int value;
+	while (queue.try_pop(value)) {
+		rest.push_back(value);
+	}
+	for (auto &p : popped) {
+		all.insert(all.end(), p.begin(), p.end());
+	}
+	all.insert(all.end(), rest.begin(), rest.end());
+	std::sort(all.begin(), all.end());
+	REQUIRE(all.size() == static_cast<size_t>(num_threads * per_thread));
+	for (int i = 0; i < num_threads * per_thread; ++i) {
+		REQUIRE(all[i] == i);
+	}
+	return rest;
+}
+
+SCENARIO("multiqueues behave like std::priority_queue when used sequentially", "[pq]") {
+	GIVEN("A multiqueue with 8 heaps") {
+		pq::multiqueue<int> queue(8);
+		std::priority_queue<int> reference;
+		uint64_t state = 42;
+		for (int i = 0; i < 20000; ++i) {
+			next_random(state);
+			const int value = static_cast<int>(state % 10000) - 5000;
+			queue.push(value);
+			reference.push(value);
+		}
+		THEN("top and pop are exact") {
+			check_drain(queue, reference);
+		}
+		THEN("try_pop removes every element once") {
+			std::vector<int> popped;
+			int value;
+			while (queue.try_pop(value)) {
+				popped.push_back(value);
+			}
+			CHECK(popped.size() == reference.size());
+			CHECK(queue.size() == 0);
+			CHECK_FALSE(queue.try_pop(value));
+		}
+	}
+}
+
+SCENARIO("multiqueues support concurrent pushes and pops", "[pq]") {
+	GIVEN("A multiqueue and threads that push distinct elements") {
+		pq::multiqueue<int> queue(8);
+		THEN("Every element is popped exactly once") {
+			check_concurrent_push_pop(queue);
+		}
+	}
+}
+
+SCENARIO("lock-free skiplists behave like std::priority_queue when used sequentially", "[pq]") {
+	GIVEN("A skiplist queue with a small bound on the deleted prefix") {
+		pq::skiplist_pq<int, 4> queue;
+		std::priority_queue<int> reference;
+		uint64_t state = 42;
+		THEN("Random pushes and pops give the same result") {
+			for (int i = 0; i < 50000; ++i) {
+				next_random(state);
+				// push more often in the first half, pop more often in the second
+				if (reference.empty() || state % 8 < (i < 25000 ? 5u : 3u)) {
+					const int value = static_cast<int>(state % 10000) - 5000;
+					queue.push(value);
+					reference.push(value);
+				} else {
+					int value;
+					REQUIRE(queue.try_pop(value));
+					REQUIRE(value == reference.top());
+					reference.pop();
+				}
+				REQUIRE(queue.size() == reference.size());
+				if (!reference.empty()) {
+					REQUIRE(queue.top() == reference.top());
+				}
+			}
+			check_drain(queue, reference);
+		}
+	}
+}
+
+SCENARIO("lock-free skiplists support concurrent pushes and pops", "[pq]") {
+	GIVEN("A skiplist queue and threads that push distinct elements") {
+		pq::skiplist_pq<int, 8> queue;
+		THEN("Every element is popped exactly once and the rest comes out in order") {
+			const std::vector<int> rest = check_concurrent_push_pop(queue);
+			CHECK(rest.size() == 40000u);
+			CHECK(std::is_sorted(rest.rbegin(), rest.rend()));
+		}
+	}
+}
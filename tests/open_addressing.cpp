@@ -0,0 +1,115 @@
+#include "catch.hpp"
+#include "random_util.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <hashtable/open_addressing.h>
+#include <hashtable/pod16.h>
+
+template <typename Map, typename Key>
+static void check_against_reference(Map &m) {
+	std::unordered_map<Key, int> reference;
+	uint64_t state = 42;
+	for (int i = 0; i < 20000; ++i) {
+		next_random(state);
+		const Key key = static_cast<Key>(1 + state % 2000);
+		if (state % 3 == 0) {
+			CHECK(m.erase(key) == reference.erase(key));
+		} else {
+			m[key] += i;
+			reference[key] += i;
+		}
+	}
+	REQUIRE(m.size() == reference.size());
+	for (auto &entry : reference) {
+		CHECK(m.find(entry.first) == just<int>(entry.second));
+	}
+	size_t visited = 0;
+	m.for_each([&](const Key &key, int &value) {
+		++visited;
+		CHECK(reference[key] == value);
+	});
+	CHECK(visited == reference.size());
+}
+
+// Keys that are equal if they agree in their lowest 16 bits
+struct low_bits_hash {
+	size_t operator()(const int key) const { return std::hash<int>()(key & 0xFFFF); }
+};
+struct low_bits_equal {
+	bool operator()(const int a, const int b) const { return (a & 0xFFFF) == (b & 0xFFFF); }
+};
+
+SCENARIO("open_addressing behaves like std::unordered_map", "[hashtable]") {
+	GIVEN("Tables with trivial slots") {
+		hashtable::open_addressing<int, int> a;
+		hashtable::open_addressing<uint64_t, int> b;
+		hashtable::open_addressing<hashtable::pod16, int> c;
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a);
+			check_against_reference<decltype(b), uint64_t>(b);
+			check_against_reference<decltype(c), hashtable::pod16>(c);
+		}
+		THEN("The empty key is never found") {
+			a[1] = 1;
+			CHECK(a.find(0) == nothing<int>());
+			CHECK(a.erase(0) == 0);
+			CHECK(a.size() == 1);
+		}
+	}
+	GIVEN("Tables with generic slots") {
+		hashtable::open_addressing<int, int, std::hash<int>, std::equal_to<int>, false> a;
+		THEN("Random inserts and erases give the same result") {
+			check_against_reference<decltype(a), int>(a);
+		}
+	}
+	GIVEN("A table of trivial keys with a custom KeyEqual") {
+		hashtable::open_addressing<int, int, low_bits_hash, low_bits_equal> m;
+		m[1] = 1;
+		m[2 + 0x10000] = 2;
+		THEN("Keys are compared with it") {
+			CHECK(m.find(1 + 0x10000) == just<int>(1));
+			CHECK(m.find(2) == just<int>(2));
+			m[1 + 0x20000] += 10;
+			CHECK(m.size() == 2);
+			CHECK(m.erase(2 + 0x30000) == 1);
+			CHECK(m.find(1) == just<int>(11));
+			CHECK(m.size() == 1);
+		}
+	}
+}
+
+SCENARIO("open_addressing with string keys", "[hashtable]") {
+	GIVEN("An open_addressing table with string keys") {
+		hashtable::open_addressing<std::string, std::string> m;
+		for (int i = 0; i < 100; ++i) {
+			m[std::to_string(i)] = std::string(i, 'x');
+		}
+		WHEN("We erase some keys") {
+			for (int i = 0; i < 100; i += 2) {
+				m.erase(std::to_string(i));
+			}
+			THEN("The others are still there") {
+				CHECK(m.size() == 50);
+				CHECK(m.find("0") == nothing<std::string>());
+				CHECK(m.find("99") == just<std::string>(std::string(99, 'x')));
+			}
+		}
+		WHEN("We merge another table into it") {
+			hashtable::open_addressing<std::string, std::string> other;
+			other["1"] = "y";
+			other["foo"] = "bar";
+			m.merge_from(std::move(other), [](std::string &ours, std::string &&theirs) {
+				ours += theirs;
+			});
+			THEN("Values are combined and new keys inserted") {
+				CHECK(m.size() == 101);
+				CHECK(m.find("1") == just<std::string>("xy"));
+				CHECK(m.find("foo") == just<std::string>("bar"));
+				CHECK(other.size() == 0);
+			}
+		}
+	}
+}
@@ -0,0 +1,851 @@
+#include "catch.hpp"
+#include "random_util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <common/io_stats.h>
+
+#include <pq/binomial_heap.h>
+#include <pq/bitset_queue.h>
+#include <pq/bucket_queue.h>
+#include <pq/dary_heap.h>
+#include <pq/external_pq.h>
+#include <pq/fibonacci_heap.h>
+#include <pq/gnu_pq.h>
+#include <pq/loser_tree.h>
+#include <pq/min_max_heap.h>
+#include <pq/pairing_heap.h>
+#include <pq/radix_heap.h>
+#include <pq/rank_pairing_heap.h>
+#include <pq/record.h>
+#include <pq/sequence_heap.h>
+#include <pq/soa_heap.h>
+#include <pq/std_pq.h>
+#include <pq/string_key.h>
+#include <pq/top_k_queue.h>
+#include <pq/weak_heap.h>
+
+// Push and pop random elements, comparing the top to std::priority_queue's
+template <typename PQ>
+static void check_against_reference(PQ &queue) {
+	using T = typename PQ::value_type;
+	std::priority_queue<T> reference;
+	uint64_t state = 42;
+	for (int i = 0; i < 50000; ++i) {
+		next_random(state);
+		// push more often in the first half, pop more often in the second
+		if (reference.empty() || state % 8 < (i < 25000 ? 5u : 3u)) {
+			const T value = static_cast<T>(static_cast<int>(state % 10000) - 5000);
+			queue.push(value);
+			reference.push(value);
+		} else {
+			queue.pop();
+			reference.pop();
+		}
+		REQUIRE(queue.size() == reference.size());
+		if (!reference.empty()) {
+			REQUIRE(queue.top() == reference.top());
+		}
+	}
+	while (!reference.empty()) {
+		REQUIRE(queue.top() == reference.top());
+		queue.pop();
+		reference.pop();
+	}
+	CHECK(queue.size() == 0);
+}
+
+// Push and pop random records, comparing the top to std::priority_queue's.
+// Keys are from a small range, so many records have equal keys.
+template <typename PQ>
+static void check_records(PQ &queue) {
+	using T = typename PQ::value_type;
+	using traits = pq::record_traits<T>;
+	std::priority_queue<T> reference;
+	uint64_t state = 42;
+	for (int i = 0; i < 20000; ++i) {
+		next_random(state);
+		if (reference.empty() || state % 8 < (i < 10000 ? 5u : 3u)) {
+			T record = traits::make(state % 1000, i);
+			reference.push(record);
+			if (i % 2 == 0) {
+				queue.push(std::move(record));
+			} else {
+				queue.push(static_cast<const T&>(record));
+			}
+		} else {
+			queue.pop();
+			reference.pop();
+		}
+		REQUIRE(queue.size() == reference.size());
+		if (!reference.empty()) {
+			REQUIRE(traits::key(queue.top()) == traits::key(reference.top()));
+		}
+	}
+	while (!reference.empty()) {
+		REQUIRE(traits::key(queue.top()) == traits::key(reference.top()));
+		queue.pop();
+		reference.pop();
+	}
+	CHECK(queue.size() == 0);
+}
+
+// Push, pop, decrease and erase random elements through handles, comparing
+// the top to the largest element of a map from the elements to their handles
+template <typename PQ>
+static void check_addressable(PQ &queue) {
+	using handle = typename PQ::handle;
+	// The low 16 bits of every element are a unique id, so that popped
+	// elements can be told apart
+	std::map<int, handle> elements;
+	int id = 0;
+	uint64_t state = 42;
+	for (int i = 0; i < 50000; ++i) {
+		next_random(state);
+		const unsigned op = state % 8;
+		const int random = (static_cast<int>(state % 10000) - 5000) * 65536;
+		if (elements.empty() || op < (i < 25000 ? 4u : 2u)) {
+			const int value = random + id++;
+			elements[value] = queue.insert(value);
+		} else if (op < 6) {
+			auto it = elements.lower_bound(random);
+			if (it == elements.end()) it = elements.begin();
+			const handle h = it->second;
+			if (op == 5) {
+				queue.erase(h);
+				elements.erase(it);
+			} else {
+				const int value = it->first + static_cast<int>(1 + (state >> 32) % 100) * 65536;
+				elements.erase(it);
+				queue.decrease_key(h, value);
+				elements[value] = h;
+			}
+		} else {
+			REQUIRE(queue.top() == elements.rbegin()->first);
+			queue.pop();
+			elements.erase(std::prev(elements.end()));
+		}
+		REQUIRE(queue.size() == elements.size());
+		if (!elements.empty()) {
+			REQUIRE(queue.top() == elements.rbegin()->first);
+		}
+	}
+}
+
+// Push and pop in bulk, comparing to std::priority_queue
+static void check_bulk(pq::priority_queue<int> &queue) {
+	std::priority_queue<int> reference;
+	std::vector<int> values(5000), out(5000);
+	uint64_t state = 42;
+	// the first batch fills an empty queue, the second doubles its size,
+	// the third and fourth are small
+	for (const size_t count : {2000, 3000, 100, 1}) {
+		for (size_t i = 0; i < count; ++i) {
+			next_random(state);
+			values[i] = static_cast<int>(state % 10000) - 5000;
+			reference.push(values[i]);
+		}
+		queue.push_bulk(values.data(), values.data() + count);
+		REQUIRE(queue.size() == reference.size());
+		REQUIRE(queue.top() == reference.top());
+		queue.pop_n(count / 2, out.data());
+		for (size_t i = 0; i < count / 2; ++i) {
+			REQUIRE(out[i] == reference.top());
+			reference.pop();
+		}
+	}
+	queue.pop_n(reference.size(), out.data());
+	for (size_t i = 0; !reference.empty(); ++i) {
+		REQUIRE(out[i] == reference.top());
+		reference.pop();
+	}
+	CHECK(queue.size() == 0);
+}
+
+// Meld queues created from queue into it, with the native meld if they are
+// of the same type and the generic one for a std_pq
+static void check_meld(pq::priority_queue<int> &queue) {
+	std::vector<std::unique_ptr<pq::priority_queue<int>>> others;
+	for (int k = 0; k < 8; ++k) {
+		others.emplace_back(queue.create_empty());
+	}
+	others.emplace_back(new pq::std_pq<int>());
+	std::vector<int> expected;
+	uint64_t state = 42;
+	for (auto &other : others) {
+		std::priority_queue<int> reference;
+		for (int i = 0; i < 1000; ++i) {
+			next_random(state);
+			const int value = static_cast<int>(state % 10000) - 5000;
+			other->push(value);
+			reference.push(value);
+		}
+		// pop some, so that lazy queues build some structure
+		for (int i = 0; i < 100; ++i) {
+			other->pop();
+			reference.pop();
+		}
+		for (; !reference.empty(); reference.pop()) {
+			expected.push_back(reference.top());
+		}
+	}
+	for (auto &other : others) {
+		queue.meld(std::move(*other));
+		REQUIRE(other->size() == 0);
+		// a melded queue can be used again
+		other->push(1);
+		REQUIRE(other->top() == 1);
+		other->pop();
+	}
+	std::sort(expected.rbegin(), expected.rend());
+	REQUIRE(queue.size() == expected.size());
+	for (const int value : expected) {
+		REQUIRE(queue.top() == value);
+		queue.pop();
+	}
+}
+
+SCENARIO("sequence heaps behave like std::priority_queue", "[pq]") {
+	GIVEN("Sequence heaps with default and tiny buffers and groups") {
+		pq::sequence_heap<int> a;
+		// many groups, so merges cascade often
+		pq::sequence_heap<int, std::less<int>, 2, 4, 2> b;
+		pq::sequence_heap<int, std::less<int>, 4, 16, 4> c;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+	}
+	GIVEN("A sequence heap of strings") {
+		pq::sequence_heap<std::string, std::less<std::string>, 4, 8, 2> queue;
+		for (int i = 0; i < 1000; ++i) {
+			queue.push(std::to_string(i * 37 % 1000));
+		}
+		THEN("They come out in descending order") {
+			std::vector<std::string> out;
+			while (queue.size() > 0) {
+				out.push_back(queue.top());
+				queue.pop();
+			}
+			REQUIRE(out.size() == 1000);
+			CHECK(std::is_sorted(out.rbegin(), out.rend()));
+		}
+	}
+}
+
+SCENARIO("d-ary heaps behave like std::priority_queue", "[pq]") {
+	GIVEN("Heaps of all arities") {
+		pq::dary_heap<int, 2> a;
+		pq::dary_heap<int, 3> b;
+		pq::dary_heap<int, 4> c;
+		pq::dary_heap<int, 8> d;
+		pq::dary_heap<int, 16> e;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+			check_against_reference(d);
+			check_against_reference(e);
+		}
+	}
+	GIVEN("A 4-ary heap") {
+		pq::dary_heap<int, 4> queue;
+		THEN("The generic meld gives the same result") {
+			check_meld(queue);
+		}
+	}
+	GIVEN("Wide heaps with scalar child selection") {
+		pq::dary_heap<int, 8, std::less<int>, false> a;
+		pq::dary_heap<int, 16, std::less<int>, false> b;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+		}
+	}
+	GIVEN("A 4-ary heap of strings") {
+		pq::dary_heap<std::string, 4> queue;
+		for (int i = 0; i < 100; ++i) {
+			queue.push(std::to_string(i * 37 % 100));
+		}
+		THEN("They come out in descending order") {
+			std::vector<std::string> out;
+			while (queue.size() > 0) {
+				out.push_back(queue.top());
+				queue.pop();
+			}
+			REQUIRE(out.size() == 100);
+			CHECK(std::is_sorted(out.rbegin(), out.rend()));
+		}
+	}
+}
+
+SCENARIO("GNU heaps behave like std::priority_queue", "[pq]") {
+	GIVEN("Pairing, binomial and thin heaps") {
+		pq::gnu_pq<int, std::less<int>, __gnu_pbds::pairing_heap_tag> a;
+		pq::gnu_pq<int, std::less<int>, __gnu_pbds::binomial_heap_tag> b;
+		pq::gnu_pq<int, std::less<int>, __gnu_pbds::thin_heap_tag> c;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+	}
+	GIVEN("A GNU pairing heap") {
+		pq::gnu_pq<int> queue;
+		THEN("Melding gives the same result") {
+			check_meld(queue);
+		}
+	}
+}
+
+SCENARIO("Addressable GNU heaps are addressable", "[pq]") {
+	GIVEN("Pairing, binomial and thin heaps") {
+		pq::gnu_addressable_pq<int, std::less<int>, __gnu_pbds::pairing_heap_tag> a;
+		pq::gnu_addressable_pq<int, std::less<int>, __gnu_pbds::binomial_heap_tag> b;
+		pq::gnu_addressable_pq<int, std::less<int>, __gnu_pbds::thin_heap_tag> c;
+		THEN("Updates through handles give the same result") {
+			check_addressable(a);
+			check_addressable(b);
+			check_addressable(c);
+		}
+	}
+	GIVEN("An addressable GNU pairing heap") {
+		pq::gnu_addressable_pq<int> queue;
+		THEN("Melding gives the same result") {
+			check_meld(queue);
+		}
+	}
+	GIVEN("An addressable GNU pairing heap melded with one that handed out handles") {
+		pq::gnu_addressable_pq<int> queue;
+		std::vector<void*> handles;
+		{
+			pq::gnu_addressable_pq<int> other;
+			for (int i = 0; i < 100; ++i) {
+				queue.push(2 * i);
+				handles.push_back(other.insert(2 * i + 1));
+			}
+			queue.meld(std::move(other));
+		}
+		THEN("The handles outlive the other heap") {
+			queue.decrease_key(handles[10], 1000);
+			queue.erase(handles[99]);
+			REQUIRE(queue.size() == 199);
+			CHECK(queue.top() == 1000);
+			queue.pop();
+			CHECK(queue.top() == 198);
+		}
+	}
+}
+
+SCENARIO("Pairing and Fibonacci heaps are addressable", "[pq]") {
+	GIVEN("Two-pass and multipass pairing heaps and a Fibonacci heap") {
+		pq::pairing_heap<int> a, a2;
+		pq::pairing_heap<int, true> b, b2;
+		pq::fibonacci_heap<int> c, c2;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+		THEN("Updates through handles give the same result") {
+			check_addressable(a2);
+			check_addressable(b2);
+			check_addressable(c2);
+		}
+		THEN("Melding gives the same result") {
+			check_meld(a2);
+			check_meld(b2);
+			check_meld(c2);
+		}
+	}
+	GIVEN("Deep heaps of strings") {
+		// inserting in ascending order makes a pairing heap a path
+		pq::pairing_heap<std::string> a;
+		pq::fibonacci_heap<std::string> b;
+		for (int i = 0; i < 200000; ++i) {
+			const std::string value = std::to_string(1000000 + i);
+			a.push(value);
+			b.push(value);
+		}
+		b.pop();
+		THEN("They are destroyed without running out of stack") {
+			CHECK(a.top() == "1199999");
+			CHECK(b.top() == "1199998");
+		}
+	}
+}
+
+SCENARIO("Binomial and rank-pairing heaps are addressable", "[pq]") {
+	GIVEN("A binomial heap and rank-pairing heaps of both types") {
+		pq::binomial_heap<int> a, a2;
+		pq::rank_pairing_heap<int, 1> b, b2;
+		pq::rank_pairing_heap<int, 2> c, c2;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+		THEN("Updates through handles give the same result") {
+			check_addressable(a2);
+			check_addressable(b2);
+			check_addressable(c2);
+		}
+		THEN("Melding gives the same result") {
+			check_meld(a2);
+			check_meld(b2);
+			check_meld(c2);
+		}
+	}
+	GIVEN("Heaps of strings") {
+		pq::binomial_heap<std::string> a;
+		pq::rank_pairing_heap<std::string, 2> b;
+		for (int i = 0; i < 1000; ++i) {
+			a.push(std::to_string(i * 37 % 1000));
+			b.push(std::to_string(i * 37 % 1000));
+		}
+		THEN("They come out in descending order") {
+			std::vector<std::string> out;
+			while (a.size() > 0) {
+				out.push_back(a.top());
+				CHECK(b.top() == a.top());
+				a.pop();
+				b.pop();
+			}
+			REQUIRE(out.size() == 1000);
+			CHECK(std::is_sorted(out.rbegin(), out.rend()));
+			CHECK(b.size() == 0);
+		}
+	}
+}
+
+SCENARIO("Bulk pushes and pops", "[pq]") {
+	GIVEN("Queues with native and generic bulk operations") {
+		pq::dary_heap<int, 2> a;
+		pq::dary_heap<int, 8> b;
+		pq::sequence_heap<int, std::less<int>, 4, 16, 4> c;
+		pq::std_pq<int> d;
+		pq::pairing_heap<int> e;
+		pq::weak_heap<int> f;
+		pq::loser_tree<int> g;
+		THEN("They give the same result as single pushes and pops") {
+			check_bulk(a);
+			check_bulk(b);
+			check_bulk(c);
+			check_bulk(d);
+			check_bulk(e);
+			check_bulk(f);
+			check_bulk(g);
+		}
+	}
+}
+
+SCENARIO("weak heaps and min-max heaps behave like std::priority_queue", "[pq]") {
+	GIVEN("Weak heaps and min-max heaps") {
+		pq::weak_heap<int> a;
+		pq::weak_heap<uint8_t> b;
+		pq::min_max_heap<int> c;
+		pq::min_max_heap<uint8_t> d;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+			check_against_reference(d);
+		}
+	}
+}
+
+SCENARIO("top-k queues keep the smallest elements", "[pq]") {
+	GIVEN("Unbounded top-k queues") {
+		pq::top_k_queue<int> a;
+		pq::top_k_queue<uint8_t> b;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+		}
+	}
+	GIVEN("Top-k queues bounded to 0, 1, 10 and 1000 elements") {
+		std::vector<int> stream(100000);
+		uint64_t state = 42;
+		for (int &value : stream) {
+			next_random(state);
+			value = static_cast<int>(state % 1000000);
+		}
+		THEN("They pop the smallest elements of a stream") {
+			for (const size_t k : {0, 1, 10, 1000}) {
+				pq::top_k_queue<int> queue;
+				pq::bounded_priority_queue<int> &bounded = queue;
+				bounded.bound(k);
+				for (const int value : stream) {
+					queue.push(value);
+					REQUIRE(queue.size() <= k);
+				}
+				std::vector<int> expected(stream);
+				std::sort(expected.begin(), expected.end());
+				expected.resize(k);
+				std::vector<int> out(k);
+				queue.pop_n(k, out.data());
+				std::reverse(out.begin(), out.end());
+				CHECK(out == expected);
+				CHECK(queue.size() == 0);
+			}
+		}
+	}
+	GIVEN("A top-k queue with more elements than the new bound") {
+		pq::top_k_queue<int> queue;
+		for (int i = 0; i < 100; ++i) {
+			queue.push(i);
+		}
+		THEN("bound pops the largest ones") {
+			queue.bound(10);
+			REQUIRE(queue.size() == 10);
+			CHECK(queue.top() == 9);
+			queue.push(5);
+			CHECK(queue.top() == 8);
+			queue.push(42);
+			CHECK(queue.top() == 8);
+			CHECK(queue.size() == 10);
+		}
+	}
+}
+
+SCENARIO("Queues of records keep their payloads", "[pq]") {
+	GIVEN("SoA heaps of all record types") {
+		pq::soa_heap<pq::pair_record, 2> a;
+		pq::soa_heap<pq::record32> b;
+		pq::soa_heap<pq::boxed_record, 8> c;
+		THEN("Random pushes and pops give the same result") {
+			check_records(a);
+			check_records(b);
+			check_records(c);
+		}
+	}
+	GIVEN("Other queues of boxed records") {
+		pq::dary_heap<pq::boxed_record> a;
+		pq::pairing_heap<pq::boxed_record> b;
+		pq::sequence_heap<pq::boxed_record> c;
+		THEN("Random pushes and pops give the same result") {
+			check_records(a);
+			check_records(b);
+			check_records(c);
+		}
+	}
+	GIVEN("A SoA heap of pairs with equal keys") {
+		pq::soa_heap<pq::pair_record> queue;
+		THEN("They come out ordered by their ids") {
+			for (uint64_t id : {3, 1, 4, 5, 9, 2, 6}) {
+				queue.push(pq::pair_record(7, id));
+			}
+			queue.push(pq::pair_record(8, 0));
+			std::vector<pq::pair_record> out(8);
+			queue.pop_n(8, out.data());
+			CHECK(out == (std::vector<pq::pair_record>{{8, 0}, {7, 9}, {7, 6}, {7, 5}, {7, 4}, {7, 3}, {7, 2}, {7, 1}}));
+		}
+	}
+	GIVEN("A SoA heap of boxed records") {
+		pq::soa_heap<pq::boxed_record> queue;
+		THEN("Each record comes out with its own payload") {
+			for (uint64_t id = 0; id < 1000; ++id) {
+				queue.push(pq::boxed_record(id * 7919 % 1000, id));
+			}
+			while (queue.size() > 0) {
+				const pq::boxed_record &record = queue.top();
+				REQUIRE(record.payload != nullptr);
+				REQUIRE(record.key == record.id() * 7919 % 1000);
+				queue.pop();
+			}
+		}
+	}
+}
+
+SCENARIO("loser trees behave like std::priority_queue", "[pq]") {
+	GIVEN("Loser trees") {
+		pq::loser_tree<int> a;
+		pq::loser_tree<uint8_t> b; // 0 is the sentinel
+		pq::loser_tree<double> c;
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+	}
+	GIVEN("A loser tree that merges sorted runs") {
+		pq::loser_tree<int> queue;
+		const int k = 100, length = 1000;
+		std::vector<int> runs(k * length);
+		uint64_t state = 42;
+		for (int r = 0; r < k; ++r) {
+			for (int i = 0; i < length; ++i) {
+				next_random(state);
+				runs[r * length + i] = static_cast<int>(state % 100000) * k + r;
+			}
+			std::sort(runs.begin() + r * length, runs.begin() + (r + 1) * length, std::greater<int>());
+		}
+		THEN("The output is sorted") {
+			std::vector<int> next(k, 1), out;
+			for (int r = 0; r < k; ++r) {
+				queue.push(runs[r * length]);
+			}
+			while (queue.size() > 0) {
+				out.push_back(queue.top());
+				queue.pop();
+				const int r = out.back() % k;
+				if (next[r] < length) {
+					queue.push(runs[r * length + next[r]++]);
+				}
+			}
+			std::sort(runs.rbegin(), runs.rend());
+			CHECK(out == runs);
+		}
+	}
+	GIVEN("A loser tree with the smallest int") {
+		pq::loser_tree<int> queue;
+		const int lowest = std::numeric_limits<int>::lowest();
+		THEN("It comes out last, once per push") {
+			queue.push(lowest);
+			queue.push(3);
+			queue.push(lowest);
+			queue.push(-3);
+			REQUIRE(queue.size() == 4);
+			CHECK(queue.top() == 3);
+			queue.pop();
+			CHECK(queue.top() == -3);
+			queue.pop();
+			CHECK(queue.top() == lowest);
+			queue.pop();
+			CHECK(queue.top() == lowest);
+			queue.pop();
+			CHECK(queue.size() == 0);
+		}
+	}
+}
+
+SCENARIO("min-max heaps are double-ended", "[pq]") {
+	GIVEN("A min-max heap") {
+		pq::min_max_heap<int> queue;
+		pq::double_ended_priority_queue<int> &depq = queue;
+		std::multiset<int> reference;
+		uint64_t state = 42;
+		THEN("Both ends are the same as a std::multiset's") {
+			for (int i = 0; i < 50000; ++i) {
+				next_random(state);
+				const uint64_t op = state % 8;
+				if (reference.empty() || op < (i < 25000 ? 5u : 3u)) {
+					const int value = static_cast<int>(state % 10000) - 5000;
+					depq.push(value);
+					reference.insert(value);
+				} else if (op % 2 == 0) {
+					depq.pop();
+					reference.erase(std::prev(reference.end()));
+				} else {
+					depq.pop_min();
+					reference.erase(reference.begin());
+				}
+				REQUIRE(depq.size() == reference.size());
+				if (!reference.empty()) {
+					REQUIRE(depq.top() == *reference.rbegin());
+					REQUIRE(depq.top_min() == *reference.begin());
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("String keys count their comparisons", "[pq]") {
+	GIVEN("A weak heap and a binary heap with the same string keys") {
+		pq::weak_heap<pq::string_key> weak;
+		pq::dary_heap<pq::string_key, 2> binary;
+		std::vector<pq::string_key> keys;
+		uint64_t state = 42;
+		for (int i = 0; i < 10000; ++i) {
+			next_random(state);
+			keys.emplace_back("rules/" + std::to_string(state % 100000));
+		}
+		THEN("Both sort them, the weak heap with fewer comparisons") {
+			std::vector<pq::string_key> sorted(keys);
+			std::sort(sorted.rbegin(), sorted.rend());
+			size_t comparisons[2];
+			pq::priority_queue<pq::string_key> *queues[2] = {&weak, &binary};
+			for (int q = 0; q < 2; ++q) {
+				pq::string_key::reset_comparisons();
+				for (const auto &key : keys) {
+					queues[q]->push(key);
+				}
+				for (const auto &key : sorted) {
+					REQUIRE(queues[q]->top() == key);
+					queues[q]->pop();
+				}
+				comparisons[q] = pq::string_key::comparisons();
+			}
+			CHECK(comparisons[0] > 0);
+			CHECK(comparisons[0] < comparisons[1]);
+		}
+	}
+}
+
+SCENARIO("radix heaps behave like std::priority_queue", "[pq]") {
+	GIVEN("Radix heaps of several widths") {
+		pq::radix_heap<uint8_t> a;
+		pq::radix_heap<uint32_t> b;
+		pq::radix_heap<uint64_t> c;
+		THEN("Random pushes and pops give the same result") {
+			// not monotone, so the fallback heap is used as well
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+	}
+	GIVEN("A radix heap with a monotone workload") {
+		pq::radix_heap<uint32_t> queue;
+		std::priority_queue<uint32_t> reference;
+		uint64_t state = 42;
+		for (int i = 0; i < 1000; ++i) {
+			next_random(state);
+			const uint32_t value = 1000000000u - static_cast<uint32_t>(state % 100000);
+			queue.push(value);
+			reference.push(value);
+		}
+		THEN("Pushing keys below the popped ones gives the same result") {
+			for (int i = 0; i < 100000; ++i) {
+				REQUIRE(queue.top() == reference.top());
+				const uint32_t key = queue.top();
+				queue.pop();
+				reference.pop();
+				next_random(state);
+				// sometimes push the popped key itself
+				const uint32_t value = key - static_cast<uint32_t>(state % 3 == 0 ? 0 : state % 1000);
+				queue.push(value);
+				reference.push(value);
+			}
+			while (!reference.empty()) {
+				REQUIRE(queue.top() == reference.top());
+				queue.pop();
+				reference.pop();
+			}
+			CHECK(queue.size() == 0);
+		}
+	}
+}
+
+SCENARIO("bucket queues behave like std::priority_queue", "[pq]") {
+	GIVEN("Bucket queues with ranges smaller and larger than the keys'") {
+		pq::bucket_queue<int> a(64);
+		pq::bucket_queue<int> b(1 << 14);
+		pq::bucket_queue<uint32_t> c(1024);
+		THEN("Random pushes and pops give the same result") {
+			// keys from a range of 10000, so a and c use the fallback heap
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+	}
+	GIVEN("A bucket queue with keys that decrease in small steps") {
+		pq::bucket_queue<int> queue(1024);
+		std::priority_queue<int> reference;
+		uint64_t state = 42;
+		for (int i = 0; i < 1000; ++i) {
+			next_random(state);
+			const int value = 1000000 - static_cast<int>(state % 1000);
+			queue.push(value);
+			reference.push(value);
+		}
+		THEN("The window follows the keys") {
+			for (int i = 0; i < 100000; ++i) {
+				REQUIRE(queue.top() == reference.top());
+				const int key = queue.top();
+				queue.pop();
+				reference.pop();
+				next_random(state);
+				const int value = key - static_cast<int>(state % 1000);
+				queue.push(value);
+				reference.push(value);
+			}
+			while (!reference.empty()) {
+				REQUIRE(queue.top() == reference.top());
+				queue.pop();
+				reference.pop();
+			}
+			CHECK(queue.size() == 0);
+		}
+	}
+}
+
+SCENARIO("bitset queues behave like std::priority_queue", "[pq]") {
+	GIVEN("Bitset queues of several widths") {
+		pq::bitset_queue<uint8_t> a;
+		pq::bitset_queue<uint16_t> b;
+		pq::bitset_queue<uint32_t> c;
+		THEN("Random pushes and pops give the same result") {
+			// many duplicates for a
+			check_against_reference(a);
+			check_against_reference(b);
+			check_against_reference(c);
+		}
+	}
+	GIVEN("A bitset queue with keys from the whole 32-bit range") {
+		pq::bitset_queue<uint32_t> queue;
+		std::vector<uint32_t> values;
+		uint64_t state = 42;
+		for (int i = 0; i < 100000; ++i) {
+			next_random(state);
+			values.push_back(static_cast<uint32_t>(state >> 32));
+			queue.push(values.back());
+		}
+		// and the extremes twice
+		for (const uint32_t value : {0u, 0u, 0xFFFFFFFFu, 0xFFFFFFFFu}) {
+			values.push_back(value);
+			queue.push(value);
+		}
+		THEN("They come out in order") {
+			std::sort(values.rbegin(), values.rend());
+			REQUIRE(queue.size() == values.size());
+			for (const uint32_t value : values) {
+				REQUIRE(queue.top() == value);
+				queue.pop();
+			}
+			CHECK(queue.size() == 0);
+		}
+	}
+}
+
+SCENARIO("External-memory queues behave like std::priority_queue", "[pq]") {
+	GIVEN("An external queue whose budget holds 1024 ints in memory") {
+		pq::external_pq<int> queue(8 << 10, 256);
+		THEN("Random pushes and pops give the same result") {
+			check_against_reference(queue);
+		}
+		THEN("Elements that are spilled to many runs come out in order") {
+			const size_t written = common::io_stats::written();
+			const size_t read = common::io_stats::read();
+			uint64_t state = 42;
+			std::vector<int> values;
+			for (int i = 0; i < 100000; ++i) {
+				next_random(state);
+				values.push_back(static_cast<int>(state % 1000000));
+				queue.push(values.back());
+			}
+			std::sort(values.rbegin(), values.rend());
+			REQUIRE(queue.size() == values.size());
+			for (const int value : values) {
+				REQUIRE(queue.top() == value);
+				queue.pop();
+			}
+			CHECK(queue.size() == 0);
+			// Everything was written at least once and read back
+			const size_t bytes_written = common::io_stats::written() - written;
+			const size_t bytes_read = common::io_stats::read() - read;
+			CHECK(bytes_written >= (100000 - 1024) * sizeof(int));
+			CHECK(bytes_read == bytes_written);
+		}
+	}
+}
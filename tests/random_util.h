@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+/// Advance a xorshift64 generator and return its new state. The tests use it
+/// instead of <random> so that their sequences are the same everywhere.
+static inline uint64_t next_random(uint64_t &state) {
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
@@ -0,0 +1,148 @@
+#include "catch.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <hashtable/rcu_hash_map.h>
+
+SCENARIO("rcu_hash_map's basic functions work", "[hashtable]") {
+	GIVEN("An rcu_hash_map") {
+		hashtable::rcu_hash_map<int, int> m;
+		const int n = 1000;
+		for (int i = 1; i <= n; ++i) {
+			m[i] = i*i;
+		}
+
+		WHEN("We ask for the elements") {
+			THEN("Their values are correct") {
+				CHECK(m.size() == n);
+				CHECK(m.find(1) == just<int>(1));
+				CHECK(m.find(10) == just<int>(100));
+				CHECK(m.find(n) == just<int>(n*n));
+				CHECK(m.find(n+1) == nothing<int>());
+			}
+		}
+
+		WHEN("We delete and reinsert elements") {
+			for (int i = 1; i <= n; i += 2) {
+				m.erase(i);
+			}
+			THEN("They are gone") {
+				CHECK(m.size() == n/2);
+				CHECK(m.find(1) == nothing<int>());
+				CHECK(m.find(2) == just<int>(4));
+			}
+			AND_THEN("They can be inserted again") {
+				m.assign(1, 42);
+				CHECK(m.find(1) == just<int>(42));
+				CHECK(m.size() == n/2 + 1);
+			}
+		}
+
+		WHEN("We clear it") {
+			m.clear();
+			THEN("It is empty") {
+				CHECK(m.size() == 0);
+				CHECK(m.find(1) == nothing<int>());
+			}
+		}
+	}
+}
+
+SCENARIO("rcu_hash_map never finds its sentinel keys", "[hashtable]") {
+	GIVEN("An empty rcu_hash_map") {
+		hashtable::rcu_hash_map<int, int> m;
+		THEN("The empty and deleted keys are not found and can't be erased") {
+			CHECK(m.find(0) == nothing<int>());
+			CHECK(m.find(-1) == nothing<int>());
+			CHECK(m.erase(0) == 0);
+			CHECK(m.erase(-1) == 0);
+			CHECK(m.size() == 0);
+		}
+	}
+	GIVEN("An rcu_hash_map with elements and tombstones") {
+		hashtable::rcu_hash_map<int, int> m;
+		for (int i = 1; i <= 100; ++i) {
+			m.assign(i, i);
+		}
+		for (int i = 1; i <= 100; i += 3) {
+			m.erase(i);
+		}
+		const size_t size = m.size();
+		THEN("The empty and deleted keys are not found and can't be erased") {
+			CHECK(m.find(0) == nothing<int>());
+			CHECK(m.find(-1) == nothing<int>());
+			CHECK(m.erase(0) == 0);
+			CHECK(m.erase(-1) == 0);
+			CHECK(m.size() == size);
+		}
+	}
+}
+
+SCENARIO("rcu_hash_map supports concurrent readers", "[hashtable]") {
+	GIVEN("An rcu_hash_map with some keys that never change") {
+		hashtable::rcu_hash_map<int, int> m;
+		const int n = 1000;
+		for (int i = 1; i <= n; ++i) {
+			m.assign(i, i);
+		}
+
+		WHEN("Readers look them up while a writer forces many resizes") {
+			std::atomic<bool> done{false};
+			std::atomic<int> errors{0};
+			std::vector<std::thread> readers;
+			for (int r = 0; r < 4; ++r) {
+				readers.emplace_back([&]() {
+					while (!done.load()) {
+						for (int i = 1; i <= n; ++i) {
+							if (m.find(i) != just<int>(i)) ++errors;
+						}
+					}
+				});
+			}
+			for (int i = n + 1; i <= 50*n; ++i) {
+				m.assign(i, i);
+				m.erase(i - n/2);
+				if (i - n/2 <= n) m.assign(i - n/2, i - n/2);
+			}
+			done = true;
+			for (auto &reader : readers) reader.join();
+
+			THEN("They always find the correct values") {
+				CHECK(errors == 0);
+				CHECK(m.size() == n + n/2);
+			}
+		}
+	}
+}
+
+SCENARIO("epoch_manager refuses more threads than it has slots", "[hashtable]") {
+	GIVEN("More live threads than max_threads") {
+		const size_t max_threads = common::epoch_manager::max_threads;
+		const size_t n = max_threads + 8;
+		std::atomic<bool> done{false};
+		std::atomic<size_t> registered{0}, refused{0};
+		std::vector<std::thread> threads;
+		for (size_t t = 0; t < n; ++t) {
+			threads.emplace_back([&]() {
+				try {
+					common::epoch_manager::thread_index();
+					++registered;
+				} catch (const std::runtime_error &) {
+					++refused;
+				}
+				while (!done.load()) std::this_thread::yield();
+			});
+		}
+		while (registered + refused < n) std::this_thread::yield();
+		done = true;
+		for (auto &thread : threads) thread.join();
+
+		THEN("The extra threads get an exception instead of a slot") {
+			CHECK(registered <= max_threads);
+			CHECK(refused >= 8u);
+		}
+	}
+}
@@ -134,3 +134,55 @@ SCENARIO("unordered_map with string keys or values", "[hashtable]") {
 		}
 	}
 }
+
+SCENARIO("unordered_map merge", "[hashtable]") {
+	GIVEN("Two unordered_maps with overlapping keys") {
+		hashtable::unordered_map<int, int> a, b;
+		for (int i = 0; i < 10; ++i) {
+			a[i] = 1;
+			b[i + 5] = 2;
+		}
+		auto sum = [](int &ours, int &&theirs) { ours += theirs; };
+
+		WHEN("We merge one into the other") {
+			a.merge_from(std::move(b), sum);
+			THEN("The union of the keys is present and common values are combined") {
+				CHECK(a.size() == 15);
+				CHECK(a.find(0) == just<int>(1));
+				CHECK(a.find(7) == just<int>(3));
+				CHECK(a.find(14) == just<int>(2));
+			}
+			AND_THEN("The source is empty") {
+				CHECK(b.size() == 0);
+			}
+		}
+
+		WHEN("We merge into an empty map") {
+			hashtable::unordered_map<int, int> c;
+			c.merge_from(std::move(a), sum);
+			THEN("It takes over all elements") {
+				CHECK(c.size() == 10);
+				CHECK(c.find(9) == just<int>(1));
+				CHECK(a.size() == 0);
+			}
+		}
+
+		WHEN("We merge a map into itself") {
+			a.merge_from(std::move(a), sum);
+			THEN("It is unchanged") {
+				CHECK(a.size() == 10);
+				CHECK(a.find(7) == just<int>(1));
+			}
+		}
+
+		WHEN("We merge through the generic implementation") {
+			using base = hashtable::hashtable<int, int>;
+			a.base::merge_from(std::move(b), sum);
+			THEN("The result is the same") {
+				CHECK(a.size() == 15);
+				CHECK(a.find(7) == just<int>(3));
+				CHECK(b.size() == 0);
+			}
+		}
+	}
+}